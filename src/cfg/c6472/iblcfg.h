@@ -75,6 +75,14 @@
 #define MAX_BIS_FUNCTION_SUPPORT    3
 
 
+/**
+ * @brief The memory regions, as { start, size } pairs, which a loaded image
+ *        may not overwrite. These hold the IBL itself at its local and global
+ *        L2 addresses.
+ */
+#define IBL_CFG_LOAD_PROTECT_REGIONS    { { 0x00800000, 0x00019d00 }, { 0x10800000, 0x00019d00 } }
+
+
 /**
  * @brief No I/O sections accepted in boot table format
  */
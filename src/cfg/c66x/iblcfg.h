@@ -69,12 +69,31 @@
 #define MAX_SIZE_STREAM_BUFFER  1520
 
 
+/**
+ * @brief Optional staging region for the network boot stream. When defined the
+ *        stream is held in this region instead of the internal buffer and keeps
+ *        the data already read, so backward seeks do not restart the transfer.
+ *        The region must be in configured memory which the boot image does not
+ *        load to.
+ */
+//#define STREAM_STAGING_BASE     0x9F000000
+//#define STREAM_STAGING_SIZE     0x01000000
+
+
 /**
  * @brief The maximum number of functions supported for BIS mode
  */
 #define MAX_BIS_FUNCTION_SUPPORT    3
 
 
+/**
+ * @brief The memory regions, as { start, size } pairs, which a loaded image
+ *        may not overwrite. These hold the IBL itself at its local and global
+ *        L2 addresses.
+ */
+#define IBL_CFG_LOAD_PROTECT_REGIONS    { { 0x00800000, 0x0001ca00 }, { 0x10800000, 0x0001ca00 } }
+
+
 /**
  * @brief No I/O sections accepted in boot table format
  */
@@ -54,6 +54,7 @@
 #include "device.h"
 #include "pllapi.h"
 #include "emif31api.h"
+#include "emif4_api.h"
 #include "pscapi.h"
 #include "gpio.h"
 #include "qm_api.h"
@@ -121,21 +122,36 @@ Uint32 deviceLocalAddrToGlobal (Uint32 addr)
 
 /**
  * @brief
- *   Enable the DDR
+ *   Start the DDR configuration
  *
  * @details
  *   The DDR controller on the c66x is an emif 4.0. The controller is
- *   initialized directly with the supplied values
+ *   initialized directly with the supplied values. The initialization
+ *   waits are completed through deviceDdrPoll
  */
-void deviceDdrConfig (void)
+void deviceDdrStart (void)
 {
     /* The emif registers must be made visible. MPAX mapping 2 is used */
     DEVICE_REG_XMPAX_L(2) =  0x10000000 | 0xff;     /* replacement addr + perm*/
     DEVICE_REG_XMPAX_H(2) =  0x2100000B;         /* base addr + seg size (64KB)*/	
 
     if (ibl.ddrConfig.configDdr != 0) {
-        hwEmif4p0Enable (&ibl.ddrConfig.uEmif.emif4p0);
+        hwEmif4p0Start (&ibl.ddrConfig.uEmif.emif4p0);
     }
+}
+
+/**
+ * @brief
+ *   Complete the DDR configuration
+ *
+ * @details
+ *   Returns non-zero while the emif initialization is in progress. Once
+ *   it is complete the memory is tested and 0 is returned
+ */
+Int32 deviceDdrPoll (void)
+{
+    if (hwEmif4p0Poll () != 0)
+        return (1);
 
     if (ddr3_memory_test() == 0)  {
         xprintf("IBL: DDR3 SUCCESS\n\r");
@@ -145,6 +161,22 @@ void deviceDdrConfig (void)
         DDR_error();
         while(1);
     }
+
+    return (0);
+}
+
+/**
+ * @brief
+ *   Enable the DDR
+ *
+ * @details
+ *   The DDR configuration is started and waited for
+ */
+void deviceDdrConfig (void)
+{
+    deviceDdrStart ();
+
+    while (deviceDdrPoll () != 0);
 }
         
 
@@ -228,7 +260,7 @@ void deviceLoadDefaultEthAddress (uint8 *maddr)
  *  @brief
  *    Compile time queue manager information
  */
-#define DEVICE_NUM_RX_CPPIS     1
+#define DEVICE_NUM_RX_CPPIS     TARGET_MAC_RCV_BURST
 #define DEVICE_NUM_TX_CPPIS     1
 #define DEVICE_NUM_CPPIS        (DEVICE_NUM_RX_CPPIS + DEVICE_NUM_TX_CPPIS)
 
@@ -244,10 +276,14 @@ uint8 qm_linkram_buf[DEVICE_NUM_CPPIS * 2 * (sizeof(uint32)/sizeof(uint8))];
 uint8 qm_cppi_buf[QM_DESC_SIZE_BYTES * DEVICE_NUM_CPPIS];
 
 
-/* The rx data buffers */
+/* The rx data buffers. The first is in PKTRAM. The rest of the burst are taken
+ * from the heap only while an ethernet boot is active, so the IBL memory map and
+ * the heap left to the other boot modes are unchanged */
 #pragma DATA_SECTION(qm_buffer, ".mac_buffer")
 #pragma DATA_ALIGN(qm_buffer, 16)
-uint8 qm_buffer[MAX_SIZE_STREAM_BUFFER * DEVICE_NUM_RX_CPPIS];
+uint8 qm_buffer[MAX_SIZE_STREAM_BUFFER];
+
+static uint8 *qm_burst_buffer = NULL;
 
 const qmConfig_t qmConfig =  {
     (UINT32) qm_linkram_buf,
@@ -274,13 +310,28 @@ void *targetGetQmConfig (void)
 void targetInitQs (void)
 {
     int32 i;
+    int32 nRx;
+    uint8 *buf;
     qmHostDesc_t *hd;
 
-    for (i = 0; i < DEVICE_NUM_RX_CPPIS; i++)  {
+    /* Buffers left by an ethernet boot which did not free the queues are reused,
+     * since the receive DMA may still own them. Without them a single descriptor
+     * is used */
+    if (qm_burst_buffer == NULL)
+        qm_burst_buffer = iblMalloc (MAX_SIZE_STREAM_BUFFER * (DEVICE_NUM_RX_CPPIS - 1) + 16);
+
+    nRx = (qm_burst_buffer != NULL) ? DEVICE_NUM_RX_CPPIS : 1;
+
+    for (i = 0; i < nRx; i++)  {
+
+        if (i == 0)
+            buf = qm_buffer;
+        else
+            buf = (uint8 *)(((UINT32)qm_burst_buffer + 15) & ~15) + MAX_SIZE_STREAM_BUFFER * (i - 1);
 
         hd                = hwQmQueuePop (DEVICE_QM_FREE_Q);
-        hd->buffLen       = sizeof (qm_buffer) / DEVICE_NUM_CPPIS;
-        hd->buffPtr       = (UINT32) &(qm_buffer[MAX_SIZE_STREAM_BUFFER * i]);
+        hd->buffLen       = MAX_SIZE_STREAM_BUFFER;
+        hd->buffPtr       = deviceLocalAddrToGlobal ((UINT32)buf);
         hd->nextBDPtr     = 0;
         hd->origBufferLen = MAX_SIZE_STREAM_BUFFER;
         hd->origBuffPtr   = hd->buffPtr;
@@ -322,7 +373,9 @@ const cpdmaRxCfg_t cpdmaEthRxCfg =  {
     0,                                  /* Queue manager for received packets */
     DEVICE_QM_RCV_Q,                    /* Queue for received packets (overridden by PA)  */
 
-    DEVICE_RX_CDMA_TIMEOUT_COUNT        /* Teardown maximum loop wait */
+    DEVICE_RX_CDMA_TIMEOUT_COUNT,       /* Teardown maximum loop wait */
+
+    DEVICE_RX_CDMA_SOP_OFFSET           /* Received packets start 2 bytes into the buffer */
 };
 
 
@@ -484,6 +537,68 @@ Int32 targetMacRcv (void *vptr_device, UINT8 *buffer)
 
 }
 
+/**
+ *  @brief
+ *      The receive descriptors handed out by targetMacRcvBurst
+ */
+static qmHostDesc_t *rxBurstHd[DEVICE_NUM_RX_CPPIS];
+static Int32         rxBurstNum = 0;
+
+/**
+ *  @brief
+ *      Receive up to maxPkts packets in place. The packets stay in the receive buffers
+ *      until targetMacRcvRelease returns the descriptors to the linked buffer queue.
+ */
+Int32 targetMacRcvBurst (void *vptr_device, UINT8 **buffer, Int32 *numBytes, Int32 maxPkts)
+{
+    qmHostDesc_t   *hd;
+    Int32           n;
+
+    /* Descriptors of a burst which was not released are returned first */
+    targetMacRcvRelease (vptr_device);
+
+    if (maxPkts > DEVICE_NUM_RX_CPPIS)
+        maxPkts = DEVICE_NUM_RX_CPPIS;
+
+    for (n = 0; n < maxPkts; n++)  {
+
+        hd = hwQmQueuePop (DEVICE_QM_RCV_Q);
+        if (hd == NULL)
+            break;
+
+        rxBurstHd[n] = hd;
+        buffer[n]    = (UINT8 *)hd->buffPtr;
+        numBytes[n]  = QM_DESC_DESCINFO_GET_PKT_LEN(hd->descInfo);
+
+    }
+
+    rxBurstNum = n;
+
+    return (n);
+
+}
+
+/**
+ *  @brief
+ *      Return the descriptors of the last burst to the linked buffer queue
+ */
+void targetMacRcvRelease (void *vptr_device)
+{
+    Int32 i;
+
+    for (i = 0; i < rxBurstNum; i++)  {
+
+        rxBurstHd[i]->buffLen = rxBurstHd[i]->origBufferLen;
+        rxBurstHd[i]->buffPtr = rxBurstHd[i]->origBuffPtr;
+
+        hwQmQueuePush (rxBurstHd[i], DEVICE_QM_LNK_BUF_Q, QM_DESC_SIZE_BYTES);
+
+    }
+
+    rxBurstNum = 0;
+
+}
+
 void targetFreeQs (void)
 {
     qmHostDesc_t   *hd;
@@ -511,6 +626,11 @@ void targetFreeQs (void)
         hd = hwQmQueuePop (DEVICE_QM_TX_Q);
 
     } while (hd != NULL);
+
+    if (qm_burst_buffer != NULL)  {
+        iblFree (qm_burst_buffer);
+        qm_burst_buffer = NULL;
+    }
     
 }    
 
@@ -303,6 +303,7 @@ void     targetInitQs (void);
 #define DEVICE_QM_ETH_TX_Q              648
 
 #define DEVICE_RX_CDMA_TIMEOUT_COUNT    1000
+#define DEVICE_RX_CDMA_SOP_OFFSET       2           /* Aligns the layer 3 headers of received packets */
 
 
 
@@ -333,6 +334,17 @@ void targetSgmiiSerdesConfig (int32 port, void *cfg);
 Int32 targetMacSend (void *ptr_device, Uint8* buffer, int num_bytes);
 Int32 targetMacRcv (void *ptr_device, UINT8 *buffer);
 
+/**
+ *  @brief
+ *      The number of receive descriptors, which is also the maximum number of
+ *      packets returned by targetMacRcvBurst. The first receive buffer is in PKTRAM.
+ *      The others are taken from the heap while an ethernet boot is active
+ *      (about 4.5KB); if that allocation fails a single descriptor is used.
+ */
+#define TARGET_MAC_RCV_BURST            4
+Int32 targetMacRcvBurst (void *ptr_device, UINT8 **buffer, Int32 *numBytes, Int32 maxPkts);
+void  targetMacRcvRelease (void *ptr_device);
+
 #define DEVICE_SS
 #define DEVICE_PSTREAM_CFG_REG_ADDR                 0x2000604
 #define DEVICE_PSTREAM_CFG_REG_VAL_ROUTE_PDSP0      0
@@ -415,6 +427,13 @@ Int32 targetMacRcv (void *ptr_device, UINT8 *buffer);
 #define DDR3_TEST_START_ADDRESS 0x80000000
 #define DDR3_TEST_END_ADDRESS   (DDR3_TEST_START_ADDRESS + (128 *1024))
 
+/**
+ *  @brief
+ *     The DDR configuration is started with deviceDdrStart and completed by polling
+ *     deviceDdrPoll, so it can overlap the boot peripheral bring up
+ */
+#define DEVICE_DDR_POLL
+
 /**
  *  @brief
  *     Software workaround for DDR3 memory corruption is to re-init the PLL's and DDR controller. This flag enables the workaround
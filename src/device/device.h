@@ -111,6 +111,17 @@ int32 devicePowerPeriph (int32 modNum);
  */
 void deviceDdrConfig (void);
 
+/**
+ * @brief Start the DDR controller configuration
+ *
+ * @details
+ *   Devices which define DEVICE_DDR_POLL start the DDR configuration
+ *   with deviceDdrStart. deviceDdrPoll advances the configuration and
+ *   returns 0 once it is complete, non-zero while it is in progress
+ */
+void  deviceDdrStart (void);
+Int32 deviceDdrPoll (void);
+
 
 /* Function to get the endian setting of a device */
 unsigned int get_device_endian();
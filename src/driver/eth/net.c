@@ -57,6 +57,7 @@ static Int32 net_read (Uint8* ptr_buf, Uint32 num_bytes);
 static Int32 net_peek (Uint8* ptr_buf, Uint32 num_bytes);
 static Int32 net_seek (Int32 loc, Int32 from);
 static Int32 net_query (void);
+static Int32 net_place (Uint8* ptr_buf, Uint32 num_bytes);
 
 /**********************************************************************
  *************************** GLOBAL Variables *************************
@@ -109,7 +110,8 @@ BOOT_MODULE_FXN_TABLE net_boot_module =
     NULL,           /* Write API (NULL: This is not interactive)      */
     net_peek,       /* Peek  API                                      */
     net_seek,       /* Seek  API                                      */
-    net_query       /* Query API                                      */
+    net_query,      /* Query API                                      */
+    net_place       /* Place API                                      */
 };
 
 /**********************************************************************
@@ -313,7 +315,8 @@ static Int32 net_open (void* ptr_driver, void (*asyncComplete)(void *))
 
     /* Basic Validation: Ensure that all the required API have been provided */
     if ((ptr_net_driver->start == NULL)   || (ptr_net_driver->send == NULL) ||
-        (ptr_net_driver->receive == NULL) || (ptr_net_driver->stop == NULL))
+        (ptr_net_driver->receive == NULL) || (ptr_net_driver->stop == NULL)  ||
+        ((ptr_net_driver->receive_burst != NULL) && (ptr_net_driver->release_burst == NULL)))
     {
         /* Error: Required API was not specified. */
         return -1;
@@ -387,24 +390,31 @@ static Int32 net_close (void)
 /**
  *  @b Description
  *  @n
- *      If a waiting packet is found it is processed
+ *      A received packet is processed
+ *
+ *  @param[in]  ptr_data_packet
+ *      The received packet, starting with the ethernet header
+ *  @param[in]  packet_size
+ *      The size of the packet in bytes
  */
-static void proc_packet (void)
+static void net_rx_frame (Uint8* ptr_data_packet, Int32 packet_size)
 {
-    Uint8*      ptr_data_packet;
-    Int32       packet_size;
     Uint16      protocol;
     Uint8       dst_mac_address[6];
 
-    /* Initialize the pointer in the received packet is stored. 
-     *  This is misaligned on the 2 byte boundary as this will ensure that
-     *  the layer3 headers i.e. IPv4 and ARP are aligned correctly. */
-    ptr_data_packet = (Uint8 *)&netmcb.rx_packet[2];
+    /* Packets received in place have to be copied if the layer3 headers 
+     * would not be aligned. In the receive packet the layer3 headers are aligned. */
+    if (((Uint32)(ptr_data_packet + sizeof(ETHHDR)) % 4) != 0)
+    {
+        if (packet_size > NET_MAX_MTU)
+        {
+            net_stats.rx_l2_dropped++;
+            return;
+        }
 
-    /* Check if a packet has been received? */
-    packet_size = netmcb.net_device.receive(&netmcb.net_device, ptr_data_packet);
-    if (packet_size == 0)
-        return;
+        netMemcpy ((void *)&netmcb.rx_packet[2], (void *)ptr_data_packet, packet_size);
+        ptr_data_packet = (Uint8 *)&netmcb.rx_packet[2];
+    }
 
     /* Increment the number of packets received. */
     net_stats.num_pkt_rxed++;
@@ -474,6 +484,51 @@ static void proc_packet (void)
 
 }
 
+/**
+ *  @b Description
+ *  @n
+ *      If waiting packets are found they are processed. Drivers which
+ *      support it hand over a burst of packets which are processed in place
+ *      and returned to the driver together.
+ */
+static void proc_packet (void)
+{
+    Uint8*      ptr_data_packet;
+    Int32       packet_size;
+    Uint8*      burst_buffer[NET_RX_BURST];
+    Int32       burst_size[NET_RX_BURST];
+    Int32       num_packets;
+    Int32       index;
+
+    if (netmcb.net_device.receive_burst != NULL)
+    {
+        /* Check if packets have been received? */
+        num_packets = netmcb.net_device.receive_burst(&netmcb.net_device, &burst_buffer[0],
+                                                       &burst_size[0], NET_RX_BURST);
+        if (num_packets <= 0)
+            return;
+
+        for (index = 0; index < num_packets; index++)
+            net_rx_frame (burst_buffer[index], burst_size[index]);
+
+        /* Return the receive buffers to the driver. */
+        netmcb.net_device.release_burst(&netmcb.net_device);
+        return;
+    }
+
+    /* Initialize the pointer in the received packet is stored. 
+     *  This is misaligned on the 2 byte boundary as this will ensure that
+     *  the layer3 headers i.e. IPv4 and ARP are aligned correctly. */
+    ptr_data_packet = (Uint8 *)&netmcb.rx_packet[2];
+
+    /* Check if a packet has been received? */
+    packet_size = netmcb.net_device.receive(&netmcb.net_device, ptr_data_packet);
+    if (packet_size == 0)
+        return;
+
+    net_rx_frame (ptr_data_packet, packet_size);
+}
+
 /**
  *  @b Description
  *  @n  
@@ -516,8 +571,9 @@ static Int32 net_read_peek (Uint8* ptr_buf, Uint32 num_bytes, Int32 op)
         }
 
 
-        /* Call the timer scheduler. */
-        timer_run();
+        /* Call the timer scheduler if a timer is due. */
+        if (timer_due() == TRUE)
+            timer_run();
 
         /* Check if there is data in the STREAM? */
         if (stream_isempty() == FALSE)
@@ -526,6 +582,9 @@ static Int32 net_read_peek (Uint8* ptr_buf, Uint32 num_bytes, Int32 op)
             if (op == NET_READ)  {
                 num_bytes_read    = stream_read (((ptr_buf + total_num_bytes_read)), num_bytes);
                 netmcb.fileOffset = netmcb.fileOffset + num_bytes_read;
+
+                /* Space was released in the stream; a held back TFTP ACK can go out. */
+                tftp_ack_pending ();
             }  else
                 num_bytes_read = stream_peek (((ptr_buf + total_num_bytes_read)), num_bytes);
 
@@ -649,8 +708,10 @@ void net_complete_transfer (void)
  *  @b  Description
  *  @n
  *      This function moves the read pointer in the stream. 
- *      Because this is a tftp boot, only forward reads
- *      are permitted.
+ *      Data which has already been received is served from the
+ *      stream as long as it is still held there. Forward seeks wait 
+ *      for the data to arrive; backward seeks to data which is no 
+ *      longer held restart the tftp transfer.
  *
  *  @param[in] loc
  *      This points to where the stream should be
@@ -686,8 +747,15 @@ static Int32 net_seek (Int32 loc, Int32 from)
     if (desiredPos == netmcb.fileOffset)
         return (0);
 
-    /* To seek backwords the current tftp transfer is completed,
-     * and then restarted */
+    /* Positions in the stream match the file offset. Seek directly if
+     * the stream still holds the data. */
+    if (stream_seek (desiredPos) == 0)  {
+        netmcb.fileOffset = desiredPos;
+        return (0);
+    }
+
+    /* To seek backwords to data which is no longer held the current
+     * tftp transfer is completed, and then restarted */
     if (desiredPos < netmcb.fileOffset)   {
 
         /* Complete the transfer */
@@ -709,8 +777,9 @@ static Int32 net_seek (Int32 loc, Int32 from)
     /* Execute the network scheduler; till there is no error. */
     while (netmcb.error_flag == 0) 
     {
-        /* Call the timer scheduler. */
-        timer_run();
+        /* Call the timer scheduler if a timer is due. */
+        if (timer_due() == TRUE)
+            timer_run();
 
         /* Check if there is data in the STREAM? */
         if (stream_isempty() == FALSE)
@@ -718,6 +787,7 @@ static Int32 net_seek (Int32 loc, Int32 from)
             /* STREAM indicates there is some data. Lets read it first. */
             num_bytes_read    = stream_read (NULL, num_bytes);
             netmcb.fileOffset = netmcb.fileOffset + num_bytes_read;
+            tftp_ack_pending ();
 
             /* Keep track of the total amount of data read till now. */
             total_num_bytes_read = total_num_bytes_read + num_bytes_read;
@@ -764,5 +834,74 @@ static Int32 net_query (void)
 {
     return (stream_level());
 }
+
+/**
+ *  @b  Description
+ *  @n
+ *      This function reads data straight into its final location. Data 
+ *      which is already in the stream is copied out first. The TFTP data
+ *      blocks which follow are placed at the destination address directly
+ *      from the received packets, bypassing the stream.
+ *
+ *  @param[in]  ptr_buf
+ *      This points to the destination of the data.
+ *
+ *  @param[in]  num_bytes
+ *      This is the number of bytes of data which need to be read.
+ *
+ *  @retval
+ *      Success -   Number of bytes placed. This is less than requested
+ *                  if the file ended.
+ *  @retval
+ *      Error   -   <0
+ */
+static Int32 net_place (Uint8* ptr_buf, Uint32 num_bytes)
+{
+    Int32       num_bytes_read;
+    Uint32      num_bytes_placed;
+
+    /* Basic Validations: Ensure that the parameters are valid. */
+    if ((ptr_buf == NULL) || (num_bytes == 0))
+        return -1;
+
+    /* Copy out any data which has already been received. */
+    num_bytes_read    = stream_read (ptr_buf, num_bytes);
+    netmcb.fileOffset = netmcb.fileOffset + num_bytes_read;
+    tftp_ack_pending ();
+
+    /* Done if the request was satisfied or the transfer is complete. */
+    if ((num_bytes_read == num_bytes) || (stream_level() < 0))
+        return (num_bytes_read);
+
+    /* The stream is now empty; the data blocks received next are placed
+     * directly behind the data which was copied out of the stream. */
+    tftp_place (ptr_buf + num_bytes_read, num_bytes - num_bytes_read);
+
+    /* Execute the network scheduler; till there is no error. */
+    while (netmcb.error_flag == 0) 
+    {
+        /* Call the timer scheduler if a timer is due. */
+        if (timer_due() == TRUE)
+            timer_run();
+
+        /* Is all the data in place, or has the transfer completed? */
+        if ((tftp_placed () == (num_bytes - num_bytes_read)) || (stream_level() < 0))
+            break;
+
+        /* Check for and process any received packets */
+        proc_packet ();
+    }
+
+    /* Stop the placement; any further data is returned through the stream. */
+    num_bytes_placed  = tftp_placed ();
+    tftp_place (NULL, 0);
+    netmcb.fileOffset = netmcb.fileOffset + num_bytes_placed;
+
+    /* Did we come out because of error or not? */
+    if (netmcb.error_flag != 0)
+        return -1;
+
+    return (num_bytes_read + num_bytes_placed);
+}
     
 
@@ -50,6 +50,14 @@
  */
 #define NET_MAX_MTU             1518
 
+/**
+ * @brief   This is the maximum number of packets the network module
+ * receives from a driver with a single receive_burst call.
+ */
+#ifndef NET_RX_BURST
+#define NET_RX_BURST            4
+#endif
+
 /**
  * @brief   This field indicates that the route is a network route
  * and any packet destined to the specific network is directly accessible.
@@ -165,6 +173,21 @@ typedef struct NET_DRV_DEVICE
      * has been received then the function returns 0
      */
     Int32 (*receive) (struct NET_DRV_DEVICE* ptr_device, Uint8* buffer);
+
+    /**
+     * @brief   Optional API invoked by the NET module to receive up to max_pkts
+     * packets in place. The driver returns the location and size of each packet
+     * in its receive buffers and the number of packets received, 0 if there are
+     * none. The buffers are used by the NET module until release_burst is called.
+     * If this is NULL the receive API is used.
+     */
+    Int32 (*receive_burst) (struct NET_DRV_DEVICE* ptr_device, Uint8** buffer, Int32* num_bytes, Int32 max_pkts);
+
+    /**
+     * @brief   The API is invoked by the NET module to return the buffers of the 
+     * packets received with receive_burst to the driver.
+     */
+    void (*release_burst) (struct NET_DRV_DEVICE* ptr_device);
     
 }NET_DRV_DEVICE;
 
@@ -154,10 +154,54 @@
  */
 #define TFTP_OPCODE_ERROR       5
 
+/**
+ * @brief   This is the TFTP opcode for OACK (RFC 2347)
+ */
+#define TFTP_OPCODE_OACK        6
+
+/**
+ * @brief   This is the TFTP error code sent by a server which refuses
+ * the options in the READ Request (RFC 2347)
+ */
+#define TFTP_ERROR_BAD_OPTION   8
+
+/**
+ * @brief   This is the smallest TFTP block size which can be negotiated 
+ * (RFC 2348)
+ */
+#define TFTP_MIN_BLKSIZE        8
+
+/**
+ * @brief   This is the largest TFTP block size which fits in a frame
+ * received by the NET module. NET_MAX_MTU includes the Ethernet header
+ * and the 4 byte frame CRC.
+ */
+#define TFTP_MAX_BLKSIZE        (NET_MAX_MTU - ETHHDR_SIZE - 4 - IPHDR_SIZE - UDPHDR_SIZE - TFTPHEADER_SIZE)
+
+/**
+ * @brief   This is the block size requested from the TFTP server through
+ * the blksize option. The value can be overridden in iblcfg.h; setting it
+ * to TFTP_DATA_SIZE disables the option negotiation.
+ */
+#ifndef TFTP_BLKSIZE
+ #define TFTP_BLKSIZE           TFTP_MAX_BLKSIZE
+#endif
+
+/**
+ * @brief   This is the number of blocks the TFTP server is asked to send
+ * for every ACK through the windowsize option (RFC 7440). The stream must
+ * hold a complete window. The value can be overridden in iblcfg.h; setting
+ * it to 1 disables the option negotiation.
+ */
+#ifndef TFTP_WINDOWSIZE
+ #define TFTP_WINDOWSIZE        4
+#endif
+
 /**
  * @brief   This is the TFTP timeout (in milliseconds) used
  * to send out periodic READ Requests if there is no response
- * detected.
+ * detected. It is also the retransmission timeout of the ACKs
+ * until the round trip time has been measured.
  */
 #define TFTP_TIMEOUT            1000
 
@@ -168,6 +212,19 @@
  */
 #define TFTP_SERVER_TIMEOUT     60000
 
+/**
+ * @brief   These are the limits (in micro-seconds) of the TFTP
+ * retransmission timeout. The timeout is derived from the measured
+ * round trip time (RFC 6298) and starts at TFTP_TIMEOUT.
+ */
+#ifndef TFTP_RTO_MIN_USEC
+ #define TFTP_RTO_MIN_USEC      2000
+#endif
+
+#ifndef TFTP_RTO_MAX_USEC
+ #define TFTP_RTO_MAX_USEC      (TFTP_TIMEOUT * 1000)
+#endif
+
 /**
  * @brief   This is the maximum number of retransmits allowed
  * in the TFTP Client after which an error is indicated.
@@ -407,6 +464,11 @@ extern Int32    udp_receive (IPHDR* ptr_iphdr);
 /* BOOTP Module exported API */
 void bootp_init (void (*asyncComplete)(void *));
 
+/* TFTP Module exported API */
+extern void      tftp_ack_pending (void);
+extern void      tftp_place (Uint8* ptr_buf, Uint32 num_bytes);
+extern Uint32    tftp_placed (void);
+
 #ifdef INCLUDE_BLF_NET_ICMP
 extern void      icmp_receive (IPHDR* ptr_iphdr);
 #endif
@@ -40,6 +40,7 @@
 */
 #include "types.h"
 #include "iblloc.h"
+#include "iblcfg.h"
 #include "net.h"
 #include "netif.h"
 #include "timer.h"
@@ -105,10 +106,43 @@ typedef struct TFTP_MCB
 
     /**
      * @brief   This is the TFTP Timer handle which is used to handle
-     * retransmissions of the READ REQUEST.
+     * retransmissions of the READ REQUEST and the ACKs.
      */
     Int32       timer;
 
+    /**
+     * @brief   This is the retransmission timeout in micro-seconds.
+     */
+    Uint32      rto;
+
+    /**
+     * @brief   This is the smoothed round trip time and its variation
+     * in micro-seconds. Both are 0 until the first sample.
+     */
+    Uint32      srtt;
+    Uint32      rttvar;
+
+    /**
+     * @brief   This is when the last READ Request or ACK was sent. 
+     */
+    Uint32      sent_time;
+
+    /**
+     * @brief   Set while the round trip time of the last READ Request or
+     * ACK can be measured. Retransmissions are not measured.
+     */
+    Bool        rtt_pending;
+
+    /**
+     * @brief   This is when the last packet was received from the server.
+     */
+    Uint32      rx_time;
+
+    /**
+     * @brief   This is the logical block number of the last ACK sent.
+     */
+    Uint32      ack_block;
+
     /**
      * @brief   This is the name of the file which is being downloaded.
      * File Names are typically exchanged through the BOOTP protocol 
@@ -117,9 +151,76 @@ typedef struct TFTP_MCB
     Uint8       filename[64];
 
     /**
-     * @brief   This is the block number we expect.
+     * @brief   This is the block number we expect. This is the logical
+     * block number in the file which unlike the 16 bit block number in 
+     * the TFTP header does not wrap around.
+     */
+    Uint32      block_num;
+
+    /**
+     * @brief   This is the block number the server wraps around to after
+     * block 65535. Servers use either 0 or 1; this is detected on the first
+     * wrap around.
+     */
+    Uint16      rollover_base;
+
+    /**
+     * @brief   This is the block size requested in the READ Request. If this
+     * is TFTP_DATA_SIZE no options are sent to the server.
+     */
+    Uint16      req_blksize;
+
+    /**
+     * @brief   This is the size of the data blocks being received. This is
+     * TFTP_DATA_SIZE unless a different size was acknowledged by the server.
+     */
+    Uint16      blksize;
+
+    /**
+     * @brief   This is the window size requested in the READ Request. If this
+     * is 1 the windowsize option is not sent to the server.
+     */
+    Uint16      req_windowsize;
+
+    /**
+     * @brief   This is the number of blocks the server sends before waiting
+     * for an ACK (RFC 7440). This is 1 unless the server acknowledged the option.
+     */
+    Uint16      windowsize;
+
+    /**
+     * @brief   This is the number of in-order blocks received in the current
+     * window.
+     */
+    Uint16      window_count;
+
+    /**
+     * @brief   Set when an out of order block has been acknowledged. Further
+     * out of order blocks of the same window are not acknowledged again.
+     */
+    Bool        gap_acked;
+
+    /**
+     * @brief   Set when the ACK closing a window has been held back because
+     * the stream does not have space for the next window.
+     */
+    Bool        ack_pending;
+
+    /**
+     * @brief   This is where received data blocks are placed directly
+     * when set through @ref tftp_place. NULL if all data goes to the stream.
+     */
+    Uint8*      place_buf;
+
+    /**
+     * @brief   This is the number of bytes which can be placed.
+     */
+    Uint32      place_len;
+
+    /**
+     * @brief   This is the number of bytes which have been placed.
      */
-    Uint16      block_num;
+    Uint32      place_done;
 
     /**
      * @brief   This is a generic buffer used by the TFTP module,
@@ -169,6 +270,240 @@ static void tftp_cleanup (void)
     return;        
 }
 
+/**
+ *  @b Description
+ *  @n  
+ *      The function restarts the TFTP Timer with the current 
+ *      retransmission timeout.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static Int32 tftp_restart_timer (void)
+{
+    if (timer_restart_usec (tftpmcb.timer, tftpmcb.rto) < 0)
+    {
+        /* Timer restart failed. */
+        mprintf ("Error: TFTP Timer restart failed\n");
+        tftp_cleanup();
+        net_set_error();
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function is called when a READ Request or ACK has been sent.
+ *
+ *  @param[in]  retransmit
+ *      TRUE if the packet was sent before.
+ *
+ *  @retval
+ *      Not Applicable
+ */
+static void tftp_sent (Bool retransmit)
+{
+    tftpmcb.sent_time   = timer_usec ();
+    tftpmcb.rtt_pending = (retransmit == TRUE) ? FALSE : TRUE;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function updates the retransmission timeout with a round trip
+ *      time sample as described in RFC 6298.
+ *
+ *  @retval
+ *      Not Applicable
+ */
+static void tftp_rtt_sample (void)
+{
+    Uint32 rtt;
+    Uint32 delta;
+
+    if (tftpmcb.rtt_pending == FALSE)
+        return;
+
+    tftpmcb.rtt_pending = FALSE;
+    rtt = timer_usec () - tftpmcb.sent_time;
+
+    if ((tftpmcb.srtt == 0) && (tftpmcb.rttvar == 0))
+    {
+        /* First sample */
+        tftpmcb.srtt   = rtt;
+        tftpmcb.rttvar = rtt >> 1;
+    }
+    else
+    {
+        /* RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R */
+        delta          = (tftpmcb.srtt > rtt) ? (tftpmcb.srtt - rtt) : (rtt - tftpmcb.srtt);
+        tftpmcb.rttvar = tftpmcb.rttvar - (tftpmcb.rttvar >> 2) + (delta >> 2);
+        tftpmcb.srtt   = tftpmcb.srtt - (tftpmcb.srtt >> 3) + (rtt >> 3);
+    }
+
+    /* RTO = SRTT + max (G, 4 * RTTVAR) */
+    delta = tftpmcb.rttvar << 2;
+    if (delta < TIMER_TICK_USEC)
+        delta = TIMER_TICK_USEC;
+
+    tftpmcb.rto = tftpmcb.srtt + delta;
+    if (tftpmcb.rto < TFTP_RTO_MIN_USEC)
+        tftpmcb.rto = TFTP_RTO_MIN_USEC;
+    if (tftpmcb.rto > TFTP_RTO_MAX_USEC)
+        tftpmcb.rto = TFTP_RTO_MAX_USEC;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function appends a TFTP option (RFC 2347) with a numeric 
+ *      value to the internal TFTP buffer.
+ *
+ *  @param[in]  index
+ *      Offset in the TFTP buffer where the option is placed.
+ *  @param[in]  name
+ *      Name of the option.
+ *  @param[in]  value
+ *      Value of the option.
+ *
+ *  @retval
+ *      Offset in the TFTP buffer following the option.
+ */
+static Int32 tftp_add_option (Int32 index, char* name, Uint32 value)
+{
+    Uint8   digits[10];
+    Int32   num_digits = 0;
+
+    /* Copy the option name including the NULL termination. */
+    do
+    {
+        tftpmcb.buffer[index++] = (Uint8)*name;
+    } while (*name++ != 0);
+
+    /* Convert the value to ASCII; the digits are generated in reverse order. */
+    do
+    {
+        digits[num_digits++] = (Uint8)('0' + (value % 10));
+        value = value / 10;
+    } while (value != 0);
+
+    while (num_digits > 0)
+        tftpmcb.buffer[index++] = digits[--num_digits];
+
+    /* Null Terminate the value. */
+    tftpmcb.buffer[index++] = 0;
+    return index;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function compares a NULL terminated option name received in an
+ *      OACK against the name of a supported option. Option names are not
+ *      case sensitive.
+ *
+ *  @retval
+ *      Match       -   TRUE
+ *  @retval
+ *      No Match    -   FALSE
+ */
+static Bool tftp_option_match (Uint8* ptr_opt, char* name)
+{
+    Uint8   ch;
+
+    do
+    {
+        /* Convert to lower case before comparing. */
+        ch = *ptr_opt++;
+        if ((ch >= 'A') && (ch <= 'Z'))
+            ch = ch - 'A' + 'a';
+
+        if (ch != (Uint8)*name)
+            return FALSE;
+
+    } while (*name++ != 0);
+
+    return TRUE;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function processes the options acknowledged by the server in 
+ *      an OACK packet. The server is allowed to acknowledge a subset of the
+ *      options requested and can only reduce the values which were requested.
+ *
+ *  @param[in]  ptr_opt
+ *      Pointer to the first option in the OACK packet.
+ *  @param[in]  num_bytes
+ *      Number of bytes of options in the packet.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static Int32 tftp_process_oack (Uint8* ptr_opt, Int32 num_bytes)
+{
+    Uint8*  ptr_end = ptr_opt + num_bytes;
+    Uint8*  ptr_name;
+    Uint32  value;
+
+    while (ptr_opt < ptr_end)
+    {
+        /* Skip over the option name. */
+        ptr_name = ptr_opt;
+        while ((ptr_opt < ptr_end) && (*ptr_opt != 0))
+            ptr_opt++;
+
+        /* The option name and value must both be NULL terminated. */
+        if (++ptr_opt >= ptr_end)
+            return -1;
+
+        /* Convert the value */
+        value = 0;
+        while ((ptr_opt < ptr_end) && (*ptr_opt != 0))
+        {
+            if ((*ptr_opt < '0') || (*ptr_opt > '9'))
+                return -1;
+
+            value = (value * 10) + (*ptr_opt - '0');
+            ptr_opt++;
+        }
+
+        if (ptr_opt++ >= ptr_end)
+            return -1;
+
+        if (tftp_option_match (ptr_name, "blksize") == TRUE)
+        {
+            /* The server can not select a block size larger than the one requested. */
+            if ((value < TFTP_MIN_BLKSIZE) || (value > tftpmcb.req_blksize))
+                return -1;
+
+            tftpmcb.blksize = (Uint16)value;
+        }
+        else if (tftp_option_match (ptr_name, "windowsize") == TRUE)
+        {
+            /* The server can not select a window larger than the one requested. */
+            if ((value < 1) || (value > tftpmcb.req_windowsize))
+                return -1;
+
+            tftpmcb.windowsize = (Uint16)value;
+        }
+        else
+        {
+            /* Options which were never requested can not be acknowledged. */
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
 /**
  *  @b Description
  *  @n  
@@ -207,6 +542,15 @@ static Int32 tftp_create_read_req (Uint8* filename)
     tftpmcb.buffer[index++] = (Uint8)'t';
     tftpmcb.buffer[index++] = (Uint8)0;
 
+    /* Request a larger block size if one is configured. The server will fall back
+     * to TFTP_DATA_SIZE blocks if it does not support the option. */
+    if (tftpmcb.req_blksize != TFTP_DATA_SIZE)
+        index = tftp_add_option (index, "blksize", tftpmcb.req_blksize);
+
+    /* Request that multiple blocks are sent for each ACK. */
+    if (tftpmcb.req_windowsize > 1)
+        index = tftp_add_option (index, "windowsize", tftpmcb.req_windowsize);
+
     /* Return the size of the read request */
     return index;
 }
@@ -214,7 +558,30 @@ static Int32 tftp_create_read_req (Uint8* filename)
 /**
  *  @b Description
  *  @n  
- *      The function is used to send an ACK back to TFTP Server.
+ *      The function converts a logical block number into the 16 bit block
+ *      number carried in the TFTP header. After block 65535 the server wraps
+ *      around to the rollover base.
+ *
+ *  @param[in]  block
+ *      Logical block number.
+ *
+ *  @retval
+ *      Block number on the wire.
+ */
+static Uint16 tftp_wire_block (Uint32 block)
+{
+    if (block <= 0xFFFF)
+        return (Uint16)block;
+
+    return (Uint16)(((block - 0x10000) % (0x10000 - tftpmcb.rollover_base)) + tftpmcb.rollover_base);
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function is used to send an ACK back to TFTP Server. The ACK
+ *      is always for the last block which was received in order, i.e. the 
+ *      block before the one we expect next.
  *
  *  @retval
  *      Not Applicable
@@ -223,24 +590,152 @@ static void tftp_send_ack(void)
 {
     TFTPHDR* ptr_tftphdr;
 
-    /* Initialize the data buffer. */ 
-    netMemset ((void *)&tftpmcb.buffer[0], 0, TFTP_DATA_SIZE + TFTPHEADER_SIZE);
+    /* Initialize the ACK header. */ 
+    netMemset ((void *)&tftpmcb.buffer[0], 0, TFTPHEADER_SIZE);
 
     /* Create an ACK packet which is to be sent out. Get the pointer to the
      * TFTP Header. */
     ptr_tftphdr = (TFTPHDR *)&tftpmcb.buffer[0];
     ptr_tftphdr->opcode = htons (TFTP_OPCODE_ACK);
-    ptr_tftphdr->block  = htons (tftpmcb.block_num);
+    ptr_tftphdr->block  = htons (tftp_wire_block (tftpmcb.block_num - 1));
 
     /* The packet has been populated; send it to the server; this transfer is now done
      * over the data socket. */
     udp_sock_send (tftpmcb.sock, (Uint8 *)ptr_tftphdr, TFTPHEADER_SIZE);
 
-    /* Increment the block number. */
-    tftpmcb.block_num++;
+    /* An ACK of the same block is a retransmission. */
+    tftp_sent ((tftpmcb.block_num - 1) == tftpmcb.ack_block);
+    tftpmcb.ack_block = tftpmcb.block_num - 1;
+
+    /* A new window starts with this ACK. */
+    tftpmcb.window_count = 0;
+    tftpmcb.gap_acked    = FALSE;
+    tftpmcb.ack_pending  = FALSE;
+
+    /* The ACK is sent again if nothing is received within the timeout. */
+    timer_restart_usec (tftpmcb.timer, tftpmcb.rto);
     return;
 }
 
+/**
+ *  @b Description
+ *  @n  
+ *      The function completes a window of data blocks. The ACK which lets
+ *      the server send the next window is only sent once the stream has
+ *      space for the complete window. Otherwise the ACK is held back until
+ *      the stream has been read by @ref tftp_ack_pending.
+ *
+ *  @retval
+ *      Not Applicable
+ */
+static void tftp_ack_window (void)
+{
+    if (stream_space() >= (tftpmcb.windowsize * tftpmcb.blksize))
+        tftp_send_ack ();
+    else
+        tftpmcb.ack_pending = TRUE;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function is called by the NET module after data has been read
+ *      from the stream. A window ACK which was held back because the stream
+ *      was full is sent once there is space for the next window.
+ *
+ *  @retval
+ *      Not Applicable
+ */
+void tftp_ack_pending (void)
+{
+    if ((tftpmcb.ack_pending == TRUE) && (tftpmcb.state == DATA_RECEIVE))
+        tftp_ack_window ();
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function is called by the NET module to have the data blocks
+ *      which are received next placed directly at their final location
+ *      instead of the stream. Data beyond the placement area is written
+ *      to the stream as usual. The stream must be empty when this is called.
+ *
+ *  @param[in]  ptr_buf
+ *      Location where the data is placed. NULL stops the placement.
+ *  @param[in]  num_bytes
+ *      Number of bytes which can be placed.
+ *
+ *  @retval
+ *      Not Applicable
+ */
+void tftp_place (Uint8* ptr_buf, Uint32 num_bytes)
+{
+    tftpmcb.place_buf  = ptr_buf;
+    tftpmcb.place_len  = num_bytes;
+    tftpmcb.place_done = 0;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function returns the number of bytes which have been placed
+ *      since the last call to @ref tftp_place.
+ *
+ *  @retval
+ *      Number of bytes placed
+ */
+Uint32 tftp_placed (void)
+{
+    return (tftpmcb.place_done);
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function stores the data of a received block. The data is placed
+ *      directly while there is space in the placement area; the remainder
+ *      is written to the stream. The block is only accepted if all of it 
+ *      can be stored.
+ *
+ *  @param[in]  ptr_data
+ *      Data of the received block.
+ *  @param[in]  num_bytes
+ *      Number of data bytes.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static Int32 tftp_store (Uint8* ptr_data, Int32 num_bytes)
+{
+    Int32 num_place = 0;
+
+    if (tftpmcb.place_buf != NULL)
+    {
+        num_place = tftpmcb.place_len - tftpmcb.place_done;
+        if (num_place > num_bytes)
+            num_place = num_bytes;
+    }
+
+    /* Anything which is not placed goes to the stream. */
+    if (stream_space() < (num_bytes - num_place))
+        return -1;
+
+    /* The stream position is moved past the placed data. */
+    if (num_place > 0)
+    {
+        netMemcpy (tftpmcb.place_buf + tftpmcb.place_done, ptr_data, num_place);
+        tftpmcb.place_done = tftpmcb.place_done + num_place;
+        stream_skip (num_place);
+    }
+
+    if ((num_bytes - num_place) > 0)
+        return (stream_write (ptr_data + num_place, num_bytes - num_place));
+
+    return 0;
+}
+
 /**
  *  @b Description
  *  @n  
@@ -253,6 +748,11 @@ static void tftp_timer_expiry (void)
 {
     Int32 len;
 
+    /* Back off the retransmission timeout. */
+    tftpmcb.rto = tftpmcb.rto << 1;
+    if (tftpmcb.rto > TFTP_RTO_MAX_USEC)
+        tftpmcb.rto = TFTP_RTO_MAX_USEC;
+
     /* Determine the state of the TFTP. */
     if (tftpmcb.state == READ_REQUEST)
     {
@@ -275,17 +775,90 @@ static void tftp_timer_expiry (void)
 
         /* Send out the READ Request again. */
         udp_sock_send (tftpmcb.sock, (Uint8 *)&tftpmcb.buffer[0], len);
+        tftp_sent (TRUE);
+        tftp_restart_timer ();
     }
     else
     {
-        /* We were receiving data from the TFTP Server and there was a timeout. This can 
-         * happen only if we have not received any data from the TFTP server. */
-        mprintf ("Error: TFTP server is down; no packet received.\n");
+        /* We were receiving data from the TFTP Server and there was a timeout. If nothing
+         * has been received for TFTP_SERVER_TIMEOUT the server has gone away. */
+        if ((timer_usec () - tftpmcb.rx_time) >= (TFTP_SERVER_TIMEOUT * 1000))
+        {
+            mprintf ("Error: TFTP server is down; no packet received.\n");
+            tftp_cleanup();
+            net_set_error();
+            return;
+        }
+
+        /* The data or our ACK was lost. The last block received in order is acknowledged 
+         * again so that the server restarts from the missing block. A held back window
+         * ACK is only sent once the stream has space. */
+        if (tftpmcb.ack_pending == FALSE)
+            tftp_send_ack ();
+        else
+            tftp_restart_timer ();
+    }
+    return;
+}
+
+/* Forward declaration: the receive routine is registered on the data socket. */
+static Int32 tftp_receive (Int32 sock, Uint8* ptr_data, Int32 num_bytes);
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function is called when the first response to the READ Request
+ *      is received. The server replies from a new port (TID) which is used
+ *      for the rest of the transfer, so the control socket is replaced by
+ *      a data socket connected to that port.
+ *
+ *  @param[in]  sock
+ *      This is the socket handle on which the response was received.
+ *  @param[in]  ptr_data
+ *      This is the pointer to the TFTP payload of the response.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0
+ */
+static Int32 tftp_open_data_socket (Int32 sock, Uint8* ptr_data)
+{
+    UDPHDR*     ptr_udphdr;
+    Uint16      src_port;
+    SOCKET      socket;
+
+    /* The socket on which the request was sent has completed its job. Lets shut 
+     * it down and open another one for the data transfers. */
+    udp_sock_close (sock);
+
+    /* We need to get the source port from where the data was received. 
+     *  This information is present in the UDP layer. This is required to
+     *  open the data socket. */
+    ptr_udphdr = (UDPHDR *)(ptr_data - sizeof(UDPHDR));
+    src_port   = ntohs(ptr_udphdr->SrcPort);
+
+    /* Populate the socket structure and register this with the UDP module. */
+    socket.local_port       = 1234;
+    socket.remote_port      = src_port;
+    socket.remote_address   = tftpmcb.server_ip;
+    socket.app_fn           = tftp_receive;
+
+    /* Move to the DATA State. */
+    tftpmcb.state           = DATA_RECEIVE;
+    tftpmcb.num_retransmits = 0;
+
+    /* Open the TFTP data socket. */
+    tftpmcb.sock = udp_sock_open (&socket);
+    if (tftpmcb.sock < 0)
+    {
+        /* Error: Data Socket open failed. */
+        mprintf ("Error: TFTP Data Socket Open Failed\n");
         tftp_cleanup();
         net_set_error();
-        return;
+        return -1;
     }
-    return;
+    return 0;
 }
 
 /**
@@ -309,9 +882,7 @@ static void tftp_timer_expiry (void)
 static Int32 tftp_receive (Int32 sock, Uint8* ptr_data, Int32 num_bytes)
 {
     TFTPHDR*    ptr_tftphdr;
-    UDPHDR*     ptr_udphdr;
-    Uint16      src_port;
-    SOCKET      socket;
+    Int32       len;
 
     /* Get the pointer to the TFTP Header. */
     ptr_tftphdr = (TFTPHDR *)ptr_data;
@@ -319,66 +890,114 @@ static Int32 tftp_receive (Int32 sock, Uint8* ptr_data, Int32 num_bytes)
     /* Process the received packet depending on the type of packet received */
     switch (ntohs(ptr_tftphdr->opcode))
     {
-        case TFTP_OPCODE_DATA:
+        case TFTP_OPCODE_OACK:
         {
-            /* Is this the first data packet we have received? */
+            /* The server has acknowledged the options in the READ Request. */
             if (tftpmcb.state == READ_REQUEST)
             {
-                /* YES. In this case the socket on which the request was sent has completed
-                 * its job. Lets shut it down and open another one for the data transfers. */
-                udp_sock_close (sock);
-
-                /* We need to get the source port from where the data was received. 
-                 *  This information is present in the UDP layer. This is required to
-                 *  open the data socket. */
-                ptr_udphdr = (UDPHDR *)(ptr_data - sizeof(UDPHDR));
-                src_port   = ntohs(ptr_udphdr->SrcPort);
-
-                /* Populate the socket structure and register this with the UDP module. */
-                socket.local_port       = 1234;
-                socket.remote_port      = src_port;
-                socket.remote_address   = tftpmcb.server_ip;
-                socket.app_fn           = tftp_receive;
-
-                /* Move to the DATA State. */
-                tftpmcb.state           = DATA_RECEIVE;
-                tftpmcb.num_retransmits = 0;
-
-                /* Close the timer.  */
-                timer_delete (tftpmcb.timer);
-                tftpmcb.timer = -1;
-
-                /* Open the TFTP data socket. */
-                tftpmcb.sock = udp_sock_open (&socket);
-                if (tftpmcb.sock < 0)
+                tftp_rtt_sample ();
+
+                /* Process the options; these follow the opcode. */
+                if (tftp_process_oack (ptr_data + 2, num_bytes - 2) < 0)
+                {
+                    mprintf ("Error: TFTP Invalid OACK received\n");
+                    tftp_cleanup();
+                    net_set_error();
+                    return -1;
+                }
+
+                /* Switch over to the data socket. */
+                if (tftp_open_data_socket (sock, ptr_data) < 0)
+                    return -1;
+            }
+            else
+            {
+                /* The OACK was retransmitted; this can only happen if our ACK of the
+                 * OACK was lost. Anything else is a protocol violation. */
+                if (tftpmcb.block_num != 1)
+                {
+                    mprintf ("Error: TFTP Unexpected OACK received\n");
+                    tftp_cleanup();
+                    net_set_error();
+                    return -1;
+                }
+
+                tftpmcb.num_retransmits++;
+                if (tftpmcb.num_retransmits > MAX_TFTP_RETRANSMITS)
                 {
-                    /* Error: Data Socket open failed. */
-                    mprintf ("Error: TFTP Data Socket Open Failed\n");
+                    mprintf ("Error: TFTP ACK Retransmits Exceeded\n");
                     tftp_cleanup();
                     net_set_error();
                     return -1;
                 }
             }
 
-            /* We are in the DATA State: Start the TFTP Server Keep Alive Timer. This timer
-             * keeps track of the TFTP Server and ensures it does not die behind us. This will
-             * help detect that error. */
-            timer_delete (tftpmcb.timer);
-            tftpmcb.timer = timer_add (TFTP_SERVER_TIMEOUT, tftp_timer_expiry);
-            if (tftpmcb.timer < 0)
+            tftpmcb.rx_time = timer_usec ();
+
+            /* The OACK is acknowledged with block number 0. */
+            tftp_send_ack ();
+            break;
+        }
+        case TFTP_OPCODE_DATA:
+        {
+            /* Is this the first data packet we have received? */
+            if (tftpmcb.state == READ_REQUEST)
             {
-                /* Timer creation failed. */
-                mprintf ("Error: TFTP Timer creation failed\n");
-                tftp_cleanup();
-                net_set_error();
+                /* YES. The server did not acknowledge any option so the transfer
+                 * uses the default block and window size. */
+                tftpmcb.blksize    = TFTP_DATA_SIZE;
+                tftpmcb.windowsize = 1;
+
+                /* Switch over to the data socket. */
+                if (tftp_open_data_socket (sock, ptr_data) < 0)
+                    return -1;
+            }
+
+            /* We are in the DATA State: Restart the TFTP Timer. The last ACK is sent again
+             * if nothing is received within the timeout, and the timer keeps track of the 
+             * TFTP Server and ensures it does not die behind us. */
+            tftpmcb.rx_time = timer_usec ();
+            if (tftp_restart_timer () < 0)
                 return -1;
+
+            /* The first time the block number wraps around detect whether the server 
+             * continues from block 0 or block 1. After block 65535 a base 0 server sends
+             * the window 0..windowsize-1 and a base 1 server the window 1..windowsize. 
+             * Block 1 alone is no evidence: if block 0 of a base 0 window is lost, block 1 
+             * arrives first, and it does so again each time the window is resent after 
+             * the ACK of block 65535. Taking base 1 from it would store every following 
+             * block one block early. Only block 'windowsize' can not be sent by a base 0 
+             * server before block 0 is acknowledged, so base 1 is taken from it. The 
+             * block itself is dropped and the window requested again. A base 1 transfer
+             * which ends before block 'windowsize' can not be told apart from a base 0 
+             * window with lost blocks; it fails once the retransmits are exceeded. */
+            if (tftpmcb.block_num == 0x10000)
+            {
+                if (ntohs(ptr_tftphdr->block) == 0)
+                    tftpmcb.rollover_base = 0;
+                else if (ntohs(ptr_tftphdr->block) == tftpmcb.windowsize)
+                    tftpmcb.rollover_base = 1;
             }
 
-            /* Received a data block. Ensure that the block number matches what we expect! */
-            if (ntohs(ptr_tftphdr->block) != tftpmcb.block_num)
+            /* Received a data block. Ensure that the block number matches what we expect! 
+             * The block is also dropped if it can not be stored. */
+            if ((ntohs(ptr_tftphdr->block) != tftp_wire_block (tftpmcb.block_num)) ||
+                (tftp_store ((ptr_data + TFTPHEADER_SIZE), (num_bytes - TFTPHEADER_SIZE)) != 0))
             {
-                /* There is a block number mismatch. This could occur if the ACK we sent was lost. 
-                 * Increment the number of retransmissions. */
+                /* There is a block number mismatch. This could occur if the ACK we sent was lost
+                 * or a block of the window was lost. The last block received in order is 
+                 * acknowledged so that the server restarts from the missing block. This is only 
+                 * done once per window, and whenever the server repeats the block we had
+                 * acknowledged last, which indicates that our ACK was lost. */
+                if ((tftpmcb.gap_acked == TRUE) && 
+                    (ntohs(ptr_tftphdr->block) != tftp_wire_block (tftpmcb.block_num - 1)))
+                    return 0;
+
+                /* A held back window ACK is only sent once the stream has space. */
+                if (tftpmcb.ack_pending == TRUE)
+                    return 0;
+
+                /* Increment the number of retransmissions. */
                 tftpmcb.num_retransmits++;
                 if (tftpmcb.num_retransmits > MAX_TFTP_RETRANSMITS)
                 {
@@ -390,42 +1009,55 @@ static Int32 tftp_receive (Int32 sock, Uint8* ptr_data, Int32 num_bytes)
                     return -1;
                 }
 
-                /* We need to send out the ACK for the previous 'block' */
-                tftpmcb.block_num = tftpmcb.block_num - 1;
-
-                /* Send the ACK out again. */
+                /* Send the ACK for the previous 'block' out again. */
                 tftp_send_ack ();
+                tftpmcb.gap_acked = TRUE;
 
                 /* We dont need to process this packet since we had already picked it up. */
                 return 0;
             }
 
-            /* The packet looks good. Reset the number of retransmissions. */
+            /* The packet looks good and has been stored. 
+             * Reset the number of retransmissions. */
+            tftp_rtt_sample ();
             tftpmcb.num_retransmits = 0;
-
-            /* Pass the received data packet to the STREAM Module. 
-             *  We need to skip the TFTP Header. */
-            if (stream_write ((ptr_data + TFTPHEADER_SIZE), (num_bytes - TFTPHEADER_SIZE)) == 0)
-            {
-                /* Packet has been copied successfully into the STREAM Buffer. */
-                tftp_send_ack();
-            }
-            else
-            {
-                /* Packet could not be copied; let the server retransmit the packet
-                 * because we did not send the ACK. */
-            }
+            tftpmcb.block_num++;
+            tftpmcb.window_count++;
 
             /* Determine if the TFTP file transfer is complete or not? 
-             *  If the received number of bytes is less than the TFTP Data Size this 
-             *  indicates that the transfer is successfully completed. */
-            if (num_bytes < (TFTP_DATA_SIZE + TFTPHEADER_SIZE))
+             *  If the received number of bytes is less than the negotiated block size 
+             *  this indicates that the transfer is successfully completed. */
+            if (num_bytes < (tftpmcb.blksize + TFTPHEADER_SIZE))
             {
                 /* Successfully downloaded the file */
+                tftp_send_ack ();
                 tftp_cleanup();
             }
+            else if (tftpmcb.window_count >= tftpmcb.windowsize)
+            {
+                /* The window is complete. */
+                tftp_ack_window ();
+            }
             break;
         }
+        case TFTP_OPCODE_ERROR:
+        {
+            /* A server which does not accept the options can refuse the READ Request. 
+             * In this case the request is repeated without any options. */
+            if ((tftpmcb.state == READ_REQUEST) && (ntohs(ptr_tftphdr->block) == TFTP_ERROR_BAD_OPTION) &&
+                ((tftpmcb.req_blksize != TFTP_DATA_SIZE) || (tftpmcb.req_windowsize > 1)))
+            {
+                tftpmcb.req_blksize    = TFTP_DATA_SIZE;
+                tftpmcb.req_windowsize = 1;
+
+                len = tftp_create_read_req (&tftpmcb.filename[0]);
+                udp_sock_send (tftpmcb.sock, (Uint8 *)&tftpmcb.buffer[0], len);
+                tftp_sent (FALSE);
+                break;
+            }
+
+            /* Fall through: any other error terminates the transfer. */
+        }
         default:
         {
             /* Control comes here for ERROR, ACK and WRQ which are all indicate 
@@ -473,16 +1105,31 @@ Int32 tftp_get_file (IPN server_ip, Int8* filename)
         return -1;
     }
 
-    /* Open the stream module. */
-    if (stream_open (TFTP_DATA_SIZE) < 0)
+    /* Initialize the TFTP MCB at this stage... */
+    netMemset ((void *)&tftpmcb, 0, sizeof(TFTP_MCB));
+
+    /* Open the stream module. The stream must be able to hold a complete window 
+     * of blocks, so the options are only requested if the stream can accept them. */
+    tftpmcb.req_blksize    = TFTP_BLKSIZE;
+    tftpmcb.req_windowsize = TFTP_WINDOWSIZE;
+    if (stream_open (tftpmcb.req_blksize * tftpmcb.req_windowsize) < 0)
     {
-        /* Error: Unable to open the stream device. */
-        net_set_error();
-        return -1;
+        tftpmcb.req_windowsize = 1;
+        if (stream_open (tftpmcb.req_blksize) < 0)
+        {
+            tftpmcb.req_blksize = TFTP_DATA_SIZE;
+            if (stream_open (TFTP_DATA_SIZE) < 0)
+            {
+                /* Error: Unable to open the stream device. */
+                net_set_error();
+                return -1;
+            }
+        }
     }
 
-    /* Initialize the TFTP MCB at this stage... */
-    netMemset ((void *)&tftpmcb, 0, sizeof(TFTP_MCB));
+    /* Until the server acknowledges the options the defaults are used. */
+    tftpmcb.blksize    = TFTP_DATA_SIZE;
+    tftpmcb.windowsize = 1;
 
     /* Populate the socket structure and register this with the UDP module. */
     socket.local_port       = 1234;
@@ -519,8 +1166,11 @@ Int32 tftp_get_file (IPN server_ip, Int8* filename)
     /* Initialize the TFTP Client state */
     tftpmcb.state = READ_REQUEST;
 
-    /* Initialize the TFTP Timer. */
-    tftpmcb.timer = timer_add (TFTP_TIMEOUT, tftp_timer_expiry);
+    /* Initialize the TFTP Timer. Until the round trip time has been measured 
+     * the retransmission timeout is TFTP_TIMEOUT. */
+    tftpmcb.rto       = TFTP_TIMEOUT * 1000;
+    tftpmcb.ack_block = 0xFFFFFFFF;
+    tftpmcb.timer     = timer_add_usec (tftpmcb.rto, tftp_timer_expiry);
     if (tftpmcb.timer < 0)
     {
         /* Error: TFTP Timer Creation Failed. TFTP is not operational. */
@@ -532,6 +1182,7 @@ Int32 tftp_get_file (IPN server_ip, Int8* filename)
 
     /* The packet has been populated; send it to the server. */
     udp_sock_send (tftpmcb.sock, (Uint8 *)&tftpmcb.buffer[0], index);
+    tftp_sent (FALSE);
  
     /* Send out the TFTP Read request. */
     return 0;
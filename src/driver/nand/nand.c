@@ -60,6 +60,18 @@
 extern void *iblMalloc (Uint32 size);
 extern void iblFree (void *mem);
 
+/**
+ *  @brief  A page held in the nand page cache
+ */
+typedef struct nandCachePage_s
+{
+    Uint8  *data;                       /**< The page data followed by the spare area */
+    Uint32  logicalBlock;               /**< The logical block number of the page */
+    Uint32  page;                       /**< The page number in the block */
+    Uint32  lastUse;                    /**< Time of the last use. Zero if the entry is not valid */
+
+} nandCachePage_t;
+
 /**
  *  @brief  The nand master control block which tracks the current nand boot information 
  */
@@ -71,7 +83,11 @@ typedef struct nandmcb_s
     Uint32  currentLogicalBlock;        /**< The logical block number of the page currently stored */
     Uint32  currentPage;                /**< The page number currently stored */
 
-    Uint8  *page;                       /**< The current page */
+    Uint8  *page;                       /**< The current page, held in the page cache */
+
+    nandCachePage_t cache[NAND_CACHE_PAGES];  /**< The most recently used pages */
+    Int32   numCachePages;              /**< The number of pages allocated in the cache */
+    Uint32  useCount;                   /**< Incremented on every cache access */
     Uint16 *logicalToPhysMap;           /**< Maps local block to physical block */
     Uint16 *physToLogicalMap;           /**< Maps a physical block number to a logical block number */
 
@@ -79,6 +95,10 @@ typedef struct nandmcb_s
     Uint8  *blocks;                     /**< There is one byte per block. A non-zero value indicates
                                              that the block is bad */
 
+    Uint32  nextScanBlock;              /**< The next physical block to check for bad block marks */
+    Uint32  numMappedBlocks;            /**< The number of logical blocks mapped so far */
+    Uint32  maxMappedBlocks;            /**< The number of logical blocks which can be mapped */
+
     nandCtbl_t *nand_if;                /**< Current low level interface (GPIO, EMIF or SPI) */
     
 
@@ -88,6 +108,163 @@ nandmcb_t nandmcb;
 
 
 
+/**
+ *  @b Description
+ *  @n
+ *
+ *  This function extends the logical to physical block map until it covers the
+ *  requested logical block. Bad blocks are identified by reading the bad block
+ *  mark pages. If the first byte in these pages is not 0xff then the block is bad.
+ *  The blocks are only checked when the boot data reaches them, so the time spent
+ *  depends on the size of the image rather than the size of the device.
+ *
+ *  The scratch memory is used to read the spare area.
+ */
+static Int32 nand_map_block (Uint32 logicalBlock, Uint8 *scratch)
+{
+    Int32 ret;
+    Int32 j;
+    Bool  badBlock;
+    Uint32 i;
+
+    while (logicalBlock >= nandmcb.numMappedBlocks)  {
+
+        if ((nandmcb.nextScanBlock >= nandmcb.devInfo.totalBlocks) ||
+            (nandmcb.numMappedBlocks >= nandmcb.maxMappedBlocks))
+            return (-1);
+
+        i        = nandmcb.nextScanBlock++;
+        badBlock = FALSE;
+        for (j = 0; j < ibl_N_BAD_BLOCK_PAGE; j++)
+        {
+            if (nandmcb.devInfo.badBlkMarkIdx[j] < nandmcb.devInfo.pageEccBytes)
+            {
+                ret = (*nandmcb.nand_if->nct_driverReadBytes)(i, 
+                    j, 
+                    nandmcb.devInfo.pageSizeBytes, 
+                    nandmcb.devInfo.pageEccBytes, 
+                    scratch);
+                if (ret < 0)
+                    return (ret);
+                
+                if (scratch[nandmcb.devInfo.badBlkMarkIdx[j]] != 0xff)
+                {
+                    badBlock = TRUE;
+                    break;
+                }
+            }
+        }
+        
+        if (badBlock)  {
+            nandmcb.blocks[i]           = 0xff;
+            nandmcb.physToLogicalMap[i] = 0xff;
+            nandmcb.numBadBlocks       += 1;
+        } else  {
+            nandmcb.blocks[i]                                   = 0;
+            nandmcb.physToLogicalMap[i]                         = nandmcb.numMappedBlocks;
+            nandmcb.logicalToPhysMap[nandmcb.numMappedBlocks++] = i;
+        }
+
+    }
+
+    return (0);
+
+}
+
+
+/**
+ *  @b Description
+ *  @n
+ *
+ *  This function reads a logical block/page through the low level driver
+ */
+static Int32 nand_read_page (Uint32 logicalBlock, Uint32 page, Uint8 *data)
+{
+    if (nand_map_block (logicalBlock, data) < 0)
+        return (-1);
+
+    return ((*nandmcb.nand_if->nct_driverReadPage)((Uint32)(nandmcb.logicalToPhysMap[logicalBlock]), page, data));
+
+}
+
+
+/**
+ *  @b Description
+ *  @n
+ *
+ *  This function returns the page cache entry holding a logical block/page,
+ *  or -1 if the page is not cached.
+ */
+static Int32 nand_cache_find (Uint32 logicalBlock, Uint32 page)
+{
+    Int32 i;
+
+    for (i = 0; i < nandmcb.numCachePages; i++)  {
+        if ((nandmcb.cache[i].lastUse != 0)                   &&
+            (nandmcb.cache[i].logicalBlock == logicalBlock)   &&
+            (nandmcb.cache[i].page         == page))
+            return (i);
+    }
+
+    return (-1);
+
+}
+
+
+/**
+ *  @b Description
+ *  @n
+ *
+ *  This function makes a logical block/page the current page. The page is taken
+ *  from the page cache if it is held there, otherwise it is read into the least
+ *  recently used cache entry. Peeks and short backward seeks by the boot formats
+ *  therefore do not read pages from the flash again.
+ */
+static Int32 nand_load_page (Uint32 logicalBlock, Uint32 page)
+{
+    Int32 i;
+
+    nandmcb.useCount += 1;
+
+    i = nand_cache_find (logicalBlock, page);
+
+    if (i < 0)  {
+
+        /* Replace the least recently used entry. Entries not in use have a zero
+         * use time and are taken first. */
+        for (i = 0; i < nandmcb.numCachePages; i++)  {
+            if (nandmcb.cache[i].lastUse == 0)
+                break;
+        }
+
+        if (i == nandmcb.numCachePages)  {
+            Int32 j;
+            for (i = 0, j = 1; j < nandmcb.numCachePages; j++)  {
+                if (nandmcb.cache[j].lastUse < nandmcb.cache[i].lastUse)
+                    i = j;
+            }
+        }
+
+        /* The entry is not valid until the read completes */
+        nandmcb.cache[i].lastUse = 0;
+
+        if (nand_read_page (logicalBlock, page, nandmcb.cache[i].data) < 0)
+            return (-1);
+
+        nandmcb.cache[i].logicalBlock = logicalBlock;
+        nandmcb.cache[i].page         = page;
+    }
+
+    nandmcb.cache[i].lastUse    = nandmcb.useCount;
+    nandmcb.page                = nandmcb.cache[i].data;
+    nandmcb.currentLogicalBlock = logicalBlock;
+    nandmcb.currentPage         = page;
+
+    return (0);
+
+}
+
+
 /**
  *  @b Description
  *  @n
@@ -129,14 +306,10 @@ Int32 nand_seek (Int32 loc, Int32 from)
 
     /* Otherwise load the desired page */
     if (nandmcb.nand_if->nct_driverReadPage != NULL)  {
-        if ((*nandmcb.nand_if->nct_driverReadPage)((Uint32)(nandmcb.logicalToPhysMap[desiredBlock]), desiredPage, nandmcb.page) < 0)
+        if (nand_load_page (desiredBlock, desiredPage) < 0)
             return (-2);
     }
 
-    /* Update the currently loaded block/page info */
-    nandmcb.currentLogicalBlock = desiredBlock;
-    nandmcb.currentPage         = desiredPage;
-
     return (0);
 
 }
@@ -149,8 +322,13 @@ Int32 nand_seek (Int32 loc, Int32 from)
  */
 Int32 nand_free_return (Int32 retcode)
 {
-    if (nandmcb.page != NULL)
-        iblFree (nandmcb.page);
+    Int32 i;
+
+    for (i = 0; i < nandmcb.numCachePages; i++)
+        iblFree (nandmcb.cache[i].data);
+
+    nandmcb.numCachePages = 0;
+    nandmcb.page          = NULL;
 
     if (nandmcb.logicalToPhysMap != NULL)
         iblFree (nandmcb.logicalToPhysMap);
@@ -180,8 +358,9 @@ Int32 nand_open (void *ptr_driver, void (*asyncComplete)(void *))
     
     Int32 size;
     Int32 ret;
-    Int32 i, j, startBlock;
-    Bool  badBlock;
+    Int32 i;
+    Uint32 blockSize;
+    void  *probe;
 
     /* Initialize the control info */
     iblMemset (&nandmcb, 0, sizeof(nandmcb));
@@ -208,17 +387,8 @@ Int32 nand_open (void *ptr_driver, void (*asyncComplete)(void *))
         return (-1);
     }
 
-    /* allocate memory for the page data and the logical to physical block map */
-    size = nandmcb.devInfo.pageSizeBytes + nandmcb.devInfo.pageEccBytes;
-    nandmcb.page = iblMalloc (size * sizeof(Uint8));
-    if (nandmcb.page == NULL)
-    {
-        nand_free_return (NAND_MALLOC_PAGE_FAIL);
-        return (-1);
-    }
-
-
-    /* Logical to physical map data */
+    /* Logical to physical map data. The maps are allocated before the page cache
+     * since the driver can not run without them. */
     nandmcb.logicalToPhysMap = iblMalloc (nandmcb.devInfo.totalBlocks * sizeof(Uint16));
     if (nandmcb.logicalToPhysMap == NULL)  
     {
@@ -245,62 +415,55 @@ Int32 nand_open (void *ptr_driver, void (*asyncComplete)(void *))
     }
 
 
-    /* Bad blocks are identified by reading page 0 and page 1. If the first 
-     * byte in these pages is not 0xff then the block is bad */
-    if (nandmcb.nand_if == NULL)
-        return (-1);
-
-    nandmcb.numBadBlocks = 0;
-    startBlock = ibln->bootAddress[iblEndianIdx][iblImageIdx]/(nandmcb.devInfo.pageSizeBytes*nandmcb.devInfo.pagesPerBlock);
-    for (i = startBlock; i < nandmcb.devInfo.totalBlocks; i++)  {
-
-        badBlock = FALSE;
-        for (j = 0; j < ibl_N_BAD_BLOCK_PAGE; j++)
+    /* allocate memory for the page cache. At least one page is required. Further 
+     * pages are only added while the heap still holds NAND_CACHE_HEAP_RESERVE bytes
+     * for the boot format loaders, which is checked with a trial allocation. */
+    size = nandmcb.devInfo.pageSizeBytes + nandmcb.devInfo.pageEccBytes;
+    for (i = 0; i < NAND_CACHE_PAGES; i++)
+    {
+        if (i > 0)
         {
-            if (nandmcb.devInfo.badBlkMarkIdx[j] < nandmcb.devInfo.pageEccBytes)
-            {
-                ret = (*nandmcb.nand_if->nct_driverReadBytes)(i, 
-                    j, 
-                    nandmcb.devInfo.pageSizeBytes, 
-                    nandmcb.devInfo.pageEccBytes, 
-                    nandmcb.page);
-                if (ret < 0)
-                {
-                    nand_free_return (ret);
-                    return (-1);
-                }
-                
-                if (nandmcb.page[nandmcb.devInfo.badBlkMarkIdx[j]] != 0xff)
-                {
-                    badBlock = TRUE;
-                    break;
-                }
-            }
+            probe = iblMalloc (size + NAND_CACHE_HEAP_RESERVE);
+            if (probe == NULL)
+                break;
+
+            iblFree (probe);
         }
-        
-        if (badBlock)  {
-            nandmcb.blocks[i] = 0xff;
-            nandmcb.numBadBlocks += 1;
-        } else
-            nandmcb.blocks[i] = 0;
 
-    }
-    
+        nandmcb.cache[i].data = iblMalloc (size * sizeof(Uint8));
+        if (nandmcb.cache[i].data == NULL)
+            break;
 
-    /* Construct the logical to physical block array */  
-    for (i = startBlock, j = 0; i < nandmcb.devInfo.totalBlocks; i++)  {
-        if (nandmcb.blocks[i] != 0xff)
-            nandmcb.logicalToPhysMap[j++] = i;
+        nandmcb.cache[i].lastUse = 0;
+        nandmcb.numCachePages   += 1;
     }
 
-    /* Construct the physical to logical block array */
-    for (i = startBlock, j = 0; i < nandmcb.devInfo.totalBlocks; i++)  {
-        if (nandmcb.blocks[i] == 0xff)
-            nandmcb.physToLogicalMap[i] = 0xff;
-        else
-            nandmcb.physToLogicalMap[i] = j++;
+    if (nandmcb.numCachePages == 0)
+    {
+        nand_free_return (NAND_MALLOC_PAGE_FAIL);
+        return (-1);
     }
 
+    nandmcb.page = nandmcb.cache[0].data;
+
+
+    if (nandmcb.nand_if == NULL)
+        return (-1);
+
+    /* The bad block info is read as the blocks are reached (see nand_map_block).
+     * A binary blob has a known size, so blocks past the end of the image are never 
+     * checked. One block more is allowed since a read which ends on a page boundary
+     * loads the next page. */
+    blockSize = nandmcb.devInfo.pageSizeBytes * nandmcb.devInfo.pagesPerBlock;
+
+    nandmcb.numBadBlocks    = 0;
+    nandmcb.numMappedBlocks = 0;
+    nandmcb.maxMappedBlocks = nandmcb.devInfo.totalBlocks;
+    nandmcb.nextScanBlock   = ibln->bootAddress[iblEndianIdx][iblImageIdx] / blockSize;
+
+    if ((ibln->bootFormat == ibl_BOOT_FORMAT_BBLOB) && (ibln->blob[iblEndianIdx][iblImageIdx].sizeBytes > 0))
+        nandmcb.maxMappedBlocks = (ibln->blob[iblEndianIdx][iblImageIdx].sizeBytes + blockSize - 1) / blockSize + 1;
+
 
     /* Seek to the first byte of the file */
     nandmcb.fpos                = -1;      /* Force a read on the first seek */
@@ -314,45 +477,89 @@ Int32 nand_open (void *ptr_driver, void (*asyncComplete)(void *))
 }
 
 
+/**
+ *  @b  Description
+ *  @n
+ *      This function advances the current block/page info to the next page
+ */
+static void nand_next_page (void)
+{
+    nandmcb.currentPage += 1;
+
+    if (nandmcb.currentPage >= nandmcb.devInfo.pagesPerBlock)  {
+        nandmcb.currentPage          = 0;
+        nandmcb.currentLogicalBlock += 1;
+    }
+}
+
+
 /**
  *  @b  Description
  *  @n
  *      This function performs a reads from the current read point
  *
+ *      Data is copied from the cached page in contiguous runs. Whole pages
+ *      in the middle of the read are read by the driver directly into the
+ *      destination buffer. The driver stores the spare area behind the page
+ *      data, so this is only done while the rest of the destination buffer
+ *      has room for it.
  */
 Int32 nand_read (Uint8 *ptr_buf, Uint32 num_bytes)
 {
+    Uint32 pIdx;
+    Uint32 n;
     Int32  i;
-    Int32  pIdx;
+    Uint32 pageSize = nandmcb.devInfo.pageSizeBytes;
 
 
     if (nandmcb.nand_if == NULL)
         return (-1);
 
     /* Convert the global file position to an offset in the currently cached page */
-    pIdx = nandmcb.fpos % nandmcb.devInfo.pageSizeBytes;
+    pIdx = nandmcb.fpos % pageSize;
+
+    while (num_bytes > 0)  {
+
+        /* Copy what is needed from the cached page */
+        n = pageSize - pIdx;
+        if (n > num_bytes)
+            n = num_bytes;
 
-    for (i = 0; i < num_bytes; i++)  {
+        iblMemcpy (ptr_buf, &nandmcb.page[pIdx], n);
+        ptr_buf      += n;
+        num_bytes    -= n;
+        nandmcb.fpos += n;
+        pIdx         += n;
 
-        ptr_buf[i]    = nandmcb.page[pIdx++];
-        nandmcb.fpos += 1;
+        /* Done if the read ended inside the cached page */
+        if (pIdx < pageSize)
+            break;
 
-        if (pIdx >= nandmcb.devInfo.pageSizeBytes)  {
+        pIdx = 0;
+        nand_next_page ();
 
-            pIdx = 0;
-            nandmcb.currentPage += 1;
+        /* Read whole pages directly into the destination buffer, unless they are cached */
+        while (num_bytes >= (pageSize + nandmcb.devInfo.pageEccBytes))  {
 
-            if (nandmcb.currentPage >= nandmcb.devInfo.pagesPerBlock)  {
-                nandmcb.currentPage          = 0;
-                nandmcb.currentLogicalBlock += 1;
+            i = nand_cache_find (nandmcb.currentLogicalBlock, nandmcb.currentPage);
+            if (i >= 0)  {
+                iblMemcpy (ptr_buf, nandmcb.cache[i].data, pageSize);
+            }  else  {
+                if (nand_read_page (nandmcb.currentLogicalBlock, nandmcb.currentPage, ptr_buf) < 0)
+                    return (-2);
             }
 
-            
-            /* Load the new page */
-            if ((*nandmcb.nand_if->nct_driverReadPage)((Uint32)(nandmcb.logicalToPhysMap[nandmcb.currentLogicalBlock]), nandmcb.currentPage, nandmcb.page) < 0)
-                return (-2);
+            ptr_buf      += pageSize;
+            num_bytes    -= pageSize;
+            nandmcb.fpos += pageSize;
 
+            nand_next_page ();
         }
+
+        /* Load the new page */
+        if (nand_load_page (nandmcb.currentLogicalBlock, nandmcb.currentPage) < 0)
+            return (-2);
+
     }
 
   return (0);
@@ -384,7 +591,7 @@ Int32 nand_peek (Uint8 *ptr_buf, Uint32 num_bytes)
     if ( (origLogicalBlock != nandmcb.currentLogicalBlock)  ||
          (origPage         != nandmcb.currentPage)  )   {
 
-            if ((*nandmcb.nand_if->nct_driverReadPage)((Uint32)(nandmcb.logicalToPhysMap[origLogicalBlock]), origPage, nandmcb.page) < 0)
+            if (nand_load_page (origLogicalBlock, origPage) < 0)
                 return (-2);
     }
     
@@ -437,7 +644,8 @@ BOOT_MODULE_FXN_TABLE nand_boot_module =
     NULL,               /* Write API */
     nand_peek,          /* Peek  API */
     nand_seek,          /* Seek  API */
-    nand_query          /* Query API */
+    nand_query,         /* Query API */
+    NULL                /* Place API */
 
 };
 
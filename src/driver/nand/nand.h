@@ -60,6 +60,25 @@
 #define NAND_BAD_BAD_BLOCK_MAGIC    -404
 #define NAND_BAD_APP_MAGIC          -405
 
+/**
+ *  @brief  The number of pages held in the nand page cache. Each page takes the 
+ *          page size plus the spare area from the heap. Pages beyond the first
+ *          are only allocated while NAND_CACHE_HEAP_RESERVE bytes of heap remain
+ *          behind them, otherwise a single page is used.
+ */
+#ifndef NAND_CACHE_PAGES
+ #define NAND_CACHE_PAGES           4
+#endif
+
+/**
+ *  @brief  The heap which is left to the boot format loaders after the page cache
+ *          has been allocated. The largest loader buffers are the boot table block
+ *          (16KB plus the read ahead) and the 16KB COFF packet buffer.
+ */
+#ifndef NAND_CACHE_HEAP_RESERVE
+ #define NAND_CACHE_HEAP_RESERVE    0x4400
+#endif
+
 extern BOOT_MODULE_FXN_TABLE nand_boot_module;
 
 
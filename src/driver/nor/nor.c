@@ -158,7 +158,8 @@ BOOT_MODULE_FXN_TABLE nor_boot_module =
     NULL,           /* Write API */
     nor_read,       /* Peek  API */
     nor_seek,       /* Seek  API */
-    nor_query       /* Query API */
+    nor_query,      /* Query API */
+    NULL            /* Place API */
 
 };
 
@@ -46,6 +46,8 @@
 #include "types.h"
 #include "iblcfg.h"
 #include "stream_osal.h"
+#include "stream.h"
+#include "timer.h"
 #include <string.h>
 
 /** 
@@ -92,19 +94,41 @@ typedef struct STREAM_MCB
     Uint8      buffer[MAX_SIZE_STREAM_BUFFER];
 
     /**
-     * @brief   This is the read index from where data is read.
+     * @brief   This is the buffer currently used by the stream. This is the
+     * internal buffer unless a larger chunk size was requested on open.
      */
-    Int32      read_idx;
+    Uint8*     ptr_buffer;
 
     /**
-     * @brief   This is the write index to which data is written.
+     * @brief   This is the size of the buffer currently used by the stream.
      */
-    Int32      write_idx;
+    Int32      size;
 
     /**
-     * @brief   This is the free size available in the internal buffer.
+     * @brief   This is the buffer allocated for large chunk sizes. It is
+     * only released on the next open since data can still be read from
+     * the stream after it has been closed.
      */
-    Int32      free_size;
+    Uint8*     ptr_alloc;
+
+    /**
+     * @brief   This is the position in the stream from where data is read.
+     * Positions count the bytes since the stream was opened and do not
+     * wrap around with the buffer.
+     */
+    Uint32     read_pos;
+
+    /**
+     * @brief   This is the position in the stream to which data is written.
+     */
+    Uint32     write_pos;
+
+    /**
+     * @brief   This is the lowest position which can still be held in the
+     * buffer. Data before the read position is retained until it is
+     * overwritten, so the stream can seek back to it.
+     */
+    Uint32     base_pos;
 }STREAM_MCB;
 
 /**********************************************************************
@@ -128,7 +152,8 @@ STREAM_MCB  stream_mcb;
  *
  *  @param[in]  chunk_size
  *      Maximum amount of data that can be received at any
- *      instant by the boot module.
+ *      instant by the boot module. If this is larger than the
+ *      internal buffer a buffer of this size is allocated.
  *
  *  @retval
  *      Success -   0
@@ -137,16 +162,51 @@ STREAM_MCB  stream_mcb;
  */
 Int32 stream_open (Uint32 chunk_size)
 {
-    /* Basic Validations: Ensure that the chunk size is not greater
-     * than the internal buffer size. */
-    if (chunk_size > MAX_SIZE_STREAM_BUFFER)
-        return -1;
+    /* Release any buffer allocated by the previous open. */
+    if (stream_mcb.ptr_alloc != NULL)
+    {
+        streamFree (stream_mcb.ptr_alloc);
+        stream_mcb.ptr_alloc = NULL;
+    }
+
+    /* Use the staging region or the internal buffer if the chunk size fits. 
+     * Otherwise allocate a buffer large enough to hold the chunk. */
+#ifdef STREAM_STAGING_SIZE
+    if (chunk_size <= STREAM_STAGING_SIZE)
+    {
+        /* The staging region may be in memory which is still being configured */
+        timer_task_wait ();
+
+        stream_mcb.ptr_buffer = (Uint8 *)STREAM_STAGING_BASE;
+        stream_mcb.size       = STREAM_STAGING_SIZE;
+    }
+    else
+#endif
+    if (chunk_size <= MAX_SIZE_STREAM_BUFFER)
+    {
+        stream_mcb.ptr_buffer = stream_mcb.buffer;
+        stream_mcb.size       = MAX_SIZE_STREAM_BUFFER;
+    }
+    else
+    {
+        stream_mcb.ptr_alloc = streamMalloc (chunk_size);
+        if (stream_mcb.ptr_alloc == NULL)
+        {
+            /* Fall back to the internal buffer; the stream is not opened. */
+            stream_mcb.ptr_buffer = stream_mcb.buffer;
+            stream_mcb.size       = MAX_SIZE_STREAM_BUFFER;
+            return -1;
+        }
+
+        stream_mcb.ptr_buffer = stream_mcb.ptr_alloc;
+        stream_mcb.size       = chunk_size;
+    }
 
     /* Initialize the Master control block. */
     stream_mcb.is_open   = TRUE;
-    stream_mcb.read_idx  = 0;
-    stream_mcb.write_idx = 0;
-    stream_mcb.free_size = MAX_SIZE_STREAM_BUFFER;
+    stream_mcb.read_pos  = 0;
+    stream_mcb.write_pos = 0;
+    stream_mcb.base_pos  = 0;
 
     /* Module has been initialized. */
     return 0;
@@ -171,15 +231,16 @@ Int32 stream_open (Uint32 chunk_size)
  */
 Int32 stream_read_peek (Uint8* ptr_data, Int32 num_bytes, Int32 op)
 {
-    Int32 index, read_index;
     Int32 num_bytes_to_read;
+    Int32 num_bytes_to_end;
+    Int32 read_idx;
     
     /* Determine the number of bytes which can be read. */
-    if (num_bytes > (MAX_SIZE_STREAM_BUFFER - stream_mcb.free_size))
+    if (num_bytes > (Int32)(stream_mcb.write_pos - stream_mcb.read_pos))
     {
         /* User has requested more data than what is available. In this case we 
          * can return only what we have. */
-        num_bytes_to_read = (MAX_SIZE_STREAM_BUFFER - stream_mcb.free_size);
+        num_bytes_to_read = (Int32)(stream_mcb.write_pos - stream_mcb.read_pos);
     }
     else
     {
@@ -188,24 +249,28 @@ Int32 stream_read_peek (Uint8* ptr_data, Int32 num_bytes, Int32 op)
         num_bytes_to_read = num_bytes;
     }
 
-    /* There is data available copy it from the internal to the user supplied buffer.  */
-    for (index = 0; index < num_bytes_to_read; index++)
+    /* There is data available copy it from the internal to the user supplied buffer. 
+     * The data wraps around the end of the circular buffer in at most one place. */
+    if ((ptr_data != NULL) && (num_bytes_to_read > 0))
     {
-        /* Copy the data to the "write" index. */
-        if (ptr_data != NULL)
+        read_idx         = stream_mcb.read_pos % stream_mcb.size;
+        num_bytes_to_end = stream_mcb.size - read_idx;
+
+        if (num_bytes_to_read <= num_bytes_to_end)
         {
-            read_index = stream_mcb.read_idx + index;
-            read_index = read_index % MAX_SIZE_STREAM_BUFFER;
-            *(ptr_data + index) = *(stream_mcb.buffer + read_index);
+            streamMemcpy (ptr_data, stream_mcb.ptr_buffer + read_idx, num_bytes_to_read);
+        }
+        else
+        {
+            streamMemcpy (ptr_data, stream_mcb.ptr_buffer + read_idx, num_bytes_to_end);
+            streamMemcpy (ptr_data + num_bytes_to_end, stream_mcb.ptr_buffer, num_bytes_to_read - num_bytes_to_end);
         }
     }
 
-    /* Increment the read index. 
-    * Once data has been copied; increment the free size accordingly */
-    if (op == STREAM_READ)  {
-        stream_mcb.read_idx  = (stream_mcb.read_idx + num_bytes_to_read) % MAX_SIZE_STREAM_BUFFER;
-        stream_mcb.free_size = stream_mcb.free_size + num_bytes_to_read;
-    }
+    /* Increment the read position. The data stays in the buffer until
+     * it is overwritten. */
+    if (op == STREAM_READ)
+        stream_mcb.read_pos = stream_mcb.read_pos + num_bytes_to_read;
 
 
     /* Return the number of bytes read. */
@@ -272,29 +337,89 @@ Int32 stream_peek (Uint8* ptr_data, Int32 num_bytes)
  */
 Int32 stream_write (Uint8* ptr_data, Int32 num_bytes)
 {
-    Int32 index;
+    Int32 num_bytes_to_end;
+    Int32 write_idx;
 
     /* Basic Validations: Ensure there is sufficient space to copy the data. */
-    if (num_bytes > stream_mcb.free_size)
+    if (num_bytes > stream_space())
         return -1;
 
     /* Basic Validations: Make sure the pointers are valid. */
     if (ptr_data == NULL)
         return -1;
 
-    /* There was sufficient space to copy the data lets do so but we copy byte by byte
-     * since the internal buffer is circular and we can wrap around... */
-    for (index = 0; index < num_bytes; index++)
-    {
-        /* Copy the data to the "write" index. */
-        *(stream_mcb.buffer + stream_mcb.write_idx) = *(ptr_data + index);
+    /* There was sufficient space to copy the data lets do so. The internal buffer 
+     * is circular so the copy is split where it wraps around... */
+    write_idx        = stream_mcb.write_pos % stream_mcb.size;
+    num_bytes_to_end = stream_mcb.size - write_idx;
 
-        /* Increment the write index. */
-        stream_mcb.write_idx = (stream_mcb.write_idx + 1) % MAX_SIZE_STREAM_BUFFER;
+    if (num_bytes <= num_bytes_to_end)
+    {
+        streamMemcpy (stream_mcb.ptr_buffer + write_idx, ptr_data, num_bytes);
+    }
+    else
+    {
+        streamMemcpy (stream_mcb.ptr_buffer + write_idx, ptr_data, num_bytes_to_end);
+        streamMemcpy (stream_mcb.ptr_buffer, ptr_data + num_bytes_to_end, num_bytes - num_bytes_to_end);
     }
 
-    /* Once data has been copied; decrement the free size accordingly */
-    stream_mcb.free_size = stream_mcb.free_size - num_bytes;
+    /* Increment the write position. */
+    stream_mcb.write_pos = stream_mcb.write_pos + num_bytes;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The function is called to move the read position of the stream.
+ *      The stream can seek back to data which has already been read as
+ *      long as it has not been overwritten, and forward up to the data
+ *      which has been written.
+ *
+ *  @param[in]  pos
+ *      New read position counted from the open of the stream.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0 (The position is not held in the buffer)
+ */
+Int32 stream_seek (Uint32 pos)
+{
+    /* Basic Validations: The data must have been written and not yet overwritten. */
+    if ((pos > stream_mcb.write_pos) || (pos < stream_mcb.base_pos) ||
+        ((stream_mcb.write_pos - pos) > stream_mcb.size))
+        return -1;
+
+    stream_mcb.read_pos = pos;
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The function is called when data has been delivered to the reader 
+ *      without passing through the stream. The read and write positions are
+ *      advanced past the data; since the data is not held in the buffer the
+ *      stream can no longer seek back before it.
+ *
+ *  @param[in]  num_bytes
+ *      Number of bytes which were delivered.
+ *
+ *  @retval
+ *      Success -   0
+ *  @retval
+ *      Error   -   <0 (The stream is not empty)
+ */
+Int32 stream_skip (Int32 num_bytes)
+{
+    /* Basic Validations: Skipped data must follow the data that was read. */
+    if (stream_mcb.read_pos != stream_mcb.write_pos)
+        return -1;
+
+    stream_mcb.write_pos = stream_mcb.write_pos + num_bytes;
+    stream_mcb.read_pos  = stream_mcb.write_pos;
+    stream_mcb.base_pos  = stream_mcb.write_pos;
     return 0;
 }
 
@@ -311,8 +436,8 @@ Int32 stream_write (Uint8* ptr_data, Int32 num_bytes)
  */
 Bool stream_isempty (void)
 {
-    /* Check the number of free bytes available? */
-    if (stream_mcb.free_size == MAX_SIZE_STREAM_BUFFER)
+    /* Check if all the data written has been read? */
+    if (stream_mcb.read_pos == stream_mcb.write_pos)
         return TRUE;
 
     /* There is data in the stream buffer; so its not empty. */
@@ -347,8 +472,9 @@ void stream_init (void)
     /* Reset the memory contents. */
     streamMemset ((void *)&stream_mcb, 0, sizeof(STREAM_MCB));
 
-    /* Make sure we initialize the free size correctly. */
-    stream_mcb.free_size = MAX_SIZE_STREAM_BUFFER;
+    /* Make sure we initialize the buffer correctly. */
+    stream_mcb.ptr_buffer = stream_mcb.buffer;
+    stream_mcb.size       = MAX_SIZE_STREAM_BUFFER;
     return;
 }
 
@@ -366,7 +492,7 @@ Int32 stream_level (void)
 {
     Int32 remain;
 
-    remain = MAX_SIZE_STREAM_BUFFER - stream_mcb.free_size;
+    remain = (Int32)(stream_mcb.write_pos - stream_mcb.read_pos);
 
     if ((stream_mcb.is_open != TRUE) && (remain == 0))
         return (-1);
@@ -374,3 +500,18 @@ Int32 stream_level (void)
     return (remain);
 
 }
+
+
+/**
+ *  @b Description
+ *  @n
+ *      Returns the number of bytes which can currently be written
+ *      to the stream
+ *
+ *  @retval
+ *      The number of free bytes in the stream buffer
+ */
+Int32 stream_space (void)
+{
+    return (stream_mcb.size - (Int32)(stream_mcb.write_pos - stream_mcb.read_pos));
+}
@@ -54,5 +54,8 @@ extern Int32 stream_peek   (Uint8* ptr_data, Int32 num_bytes);
 extern Int32 stream_write  (Uint8* ptr_data, Int32 num_bytes);
 extern Bool  stream_isempty(void);
 extern Int32 stream_level  (void);
+extern Int32 stream_space  (void);
+extern Int32 stream_seek   (Uint32 pos);
+extern Int32 stream_skip   (Int32 num_bytes);
 
 #endif /* __STREAM_H__ */
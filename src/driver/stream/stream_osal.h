@@ -8,3 +8,6 @@
 #include "iblloc.h"
 
 #define streamMemset iblMemset
+#define streamMemcpy iblMemcpy
+#define streamMalloc iblMalloc
+#define streamFree   iblFree
@@ -47,6 +47,20 @@
  #include <string.h>
 
 
+/**********************************************************************
+ *************************** LOCAL Definitions ************************
+ **********************************************************************/
+
+/**
+ * @brief  Terminates the timer lists of the timer wheel.
+ */
+#define TIMER_NIL           0xff
+
+/**
+ * @brief  Device timer count which is never reached.
+ */
+#define TIMER_COUNT_NEVER   0xffffffffffffffffull
+
 /**********************************************************************
  *************************** LOCAL Structures *************************
  **********************************************************************/
@@ -57,7 +71,8 @@
  *
  * @details
  *  Each timer in the system is associated with a timer
- *  block.  
+ *  block. Active timers are linked into the slot of the timer wheel
+ *  selected by their expiration tick.
  */
 typedef struct TIMER_BLOCK
 {
@@ -68,15 +83,20 @@ typedef struct TIMER_BLOCK
     void        (*expiry)(void);
 
     /**
-     * @brief  This is the original expiration time in milli-seconds.
+     * @brief  This is the period of the timer in ticks.
+     */
+    Uint32      period;
+
+    /**
+     * @brief  This is the tick at which the timer expires.
      */
-    Uint32      org_timeout;
+    Uint32      expires;
 
     /**
-     * @brief  This is the expiration time in milli-seconds. This is
-     * decremented by the timer module.
+     * @brief  Next and previous timer blocks in the wheel slot.
      */
-    Uint32      timeout;
+    Uint8       next;
+    Uint8       prev;
 }TIMER_BLOCK;
 
 /**
@@ -84,8 +104,12 @@ typedef struct TIMER_BLOCK
  *  The structure describes the Timer Master Control Block.
  *
  * @details
- *  The structure contains information about the Timer Master Control
- *  block which stores information about the Timer Module.
+ *  The structure contains information about the Timer Module. Time is
+ *  kept in ticks of TIMER_TICK_USEC, derived from the free running
+ *  device timer. The timers are hashed into a timer wheel by their
+ *  expiration tick, so adding and deleting a timer does not depend on
+ *  the number of timers, and the scheduler only visits the wheel slots
+ *  of the ticks which have passed.
  */
 typedef struct TIMER_MCB
 {
@@ -99,6 +123,53 @@ typedef struct TIMER_MCB
      * @brief  This is the number of active timers in the system.
      */
     Uint32        num_active_timers;
+
+    /**
+     * @brief  The timer wheel. Each slot is the head of a list of
+     * timer blocks.
+     */
+    Uint8         wheel[TIMER_WHEEL_SIZE];
+
+    /**
+     * @brief  This is the last tick processed by the scheduler.
+     */
+    Uint32        tick;
+
+    /**
+     * @brief  Number of device timer counts in a tick.
+     */
+    Uint32        tick_counts;
+
+    /**
+     * @brief  The earliest expiration tick of the active timers, and the
+     * device timer count at which it is reached. They are recomputed 
+     * when next_dirty is set.
+     */
+    Uint32              next_expiry;
+    unsigned long long  next_count;
+    Bool                next_dirty;
+
+    /**
+     * @brief  Set while the device timer is running.
+     */
+    Bool          dev_active;
+
+    /**
+     * @brief  Set while the scheduler runs the expiration routines.
+     */
+    Bool          in_run;
+
+    /**
+     * @brief  This keeps track of the background tasks. Each task is a 
+     * poll routine which advances its state machine and returns 0 once
+     * the task is complete.
+     */
+    Int32         (*task[MAX_TIMER_TASKS])(void);
+
+    /**
+     * @brief  This is the number of active tasks in the system.
+     */
+    Uint32        num_active_tasks;
 }TIMER_MCB;
 
 /**********************************************************************
@@ -115,6 +186,114 @@ TIMER_MCB   timermcb;
  *************************** TIMER Functions **************************
  **********************************************************************/
 
+/**
+ *  @b Description
+ *  @n  
+ *      The function returns the current tick.
+ *
+ *  @retval
+ *      The current tick
+ */
+static Uint32 timer_now (void)
+{
+    return ((Uint32)(dev_read_timer () / timermcb.tick_counts));
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function links a timer block into the wheel slot of its
+ *      expiration tick.
+ *
+ *  @param[in]  index
+ *      Index of the timer block.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void timer_link (Uint8 index)
+{
+    TIMER_BLOCK* ptr_timer = &timermcb.timer[index];
+    Uint8        slot      = ptr_timer->expires & (TIMER_WHEEL_SIZE - 1);
+
+    ptr_timer->prev = TIMER_NIL;
+    ptr_timer->next = timermcb.wheel[slot];
+    if (ptr_timer->next != TIMER_NIL)
+        timermcb.timer[ptr_timer->next].prev = index;
+    timermcb.wheel[slot] = index;
+
+    /* Keep the next deadline up to date if this timer is the earliest. */
+    if ((timermcb.next_dirty == FALSE) && ((Int32)(ptr_timer->expires - timermcb.next_expiry) < 0))
+    {
+        timermcb.next_expiry = ptr_timer->expires;
+        timermcb.next_count  = (unsigned long long)ptr_timer->expires * timermcb.tick_counts;
+    }
+    return;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function removes a timer block from its wheel slot.
+ *
+ *  @param[in]  index
+ *      Index of the timer block.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void timer_unlink (Uint8 index)
+{
+    TIMER_BLOCK* ptr_timer = &timermcb.timer[index];
+
+    if (ptr_timer->prev != TIMER_NIL)
+        timermcb.timer[ptr_timer->prev].next = ptr_timer->next;
+    else
+        timermcb.wheel[ptr_timer->expires & (TIMER_WHEEL_SIZE - 1)] = ptr_timer->next;
+
+    if (ptr_timer->next != TIMER_NIL)
+        timermcb.timer[ptr_timer->next].prev = ptr_timer->prev;
+
+    /* The next deadline is recomputed when it is needed. */
+    if (ptr_timer->expires == timermcb.next_expiry)
+        timermcb.next_dirty = TRUE;
+    return;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function recomputes the next deadline from the active timers.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+static void timer_update_next (void)
+{
+    Uint16  index;
+    Bool    found = FALSE;
+
+    for (index = 0; index < MAX_TIMER_BLOCKS; index++)
+    {
+        if (timermcb.timer[index].expiry == NULL)
+            continue;
+
+        if ((found == FALSE) || ((Int32)(timermcb.timer[index].expires - timermcb.next_expiry) < 0))
+        {
+            timermcb.next_expiry = timermcb.timer[index].expires;
+            found = TRUE;
+        }
+    }
+
+    if (found == TRUE)
+        timermcb.next_count = (unsigned long long)timermcb.next_expiry * timermcb.tick_counts;
+    else
+        timermcb.next_count = TIMER_COUNT_NEVER;
+
+    timermcb.next_dirty = FALSE;
+    return;
+}
+
 /**
  *  @b Description
  *  @n  
@@ -127,16 +306,19 @@ void timer_init (void)
 {
     /* Initialize the Timer Master Control Block. */
     timerMemset (&timermcb, 0, sizeof(TIMER_MCB));
+    timerMemset (&timermcb.wheel[0], TIMER_NIL, sizeof(timermcb.wheel));
+    timermcb.next_count = TIMER_COUNT_NEVER;
     return;
 }
 
 /**
  *  @b Description
  *  @n  
- *      The function creates a timer.
+ *      The function creates a timer with a timeout in micro-seconds. The
+ *      timeout is rounded up to the timer tick, TIMER_TICK_USEC.
  *
  *  @param[in]  timeout
- *      This is the timeout specified in milli-seconds after which the timer
+ *      This is the timeout specified in micro-seconds after which the timer
  *      will expire.
  *  @param[in]  expiry
  *      Expiration routine which is called to indicate that the timer block
@@ -147,7 +329,7 @@ void timer_init (void)
  *  @retval
  *      Error    -  <0
  */
-Int32 timer_add (Uint32 timeout, void (*expiry)(void))
+Int32 timer_add_usec (Uint32 timeout, void (*expiry)(void))
 {
     Uint16  index;
 
@@ -162,10 +344,10 @@ Int32 timer_add (Uint32 timeout, void (*expiry)(void))
          * that the timer block is free. */
         if (timermcb.timer[index].expiry == NULL)
         {
-            /* Found a free slot. Is this the first timer being created? */
-            if (timermcb.num_active_timers == 0)
+            /* Found a free slot. Is the device timer running? */
+            if (timermcb.dev_active == FALSE)
             {
-                /* YES. We need to start the device timer. */
+                /* NO. We need to start the device timer. */
                 if (dev_create_timer() < 0)
                 {
                     /* Device layer timer creation failed. We will not be able
@@ -173,12 +355,23 @@ Int32 timer_add (Uint32 timeout, void (*expiry)(void))
                      * might as well fail also. */
                     return -1;
                 }
+
+                /* The device timer counts from 0 again */
+                timermcb.tick_counts = dev_timer_counts (TIMER_TICK_USEC);
+                timermcb.tick        = 0;
+                timermcb.dev_active  = TRUE;
             }
 
             /* Populate the timer block structure. */
-            timermcb.timer[index].expiry      = expiry;
-            timermcb.timer[index].timeout     = timeout;
-            timermcb.timer[index].org_timeout = timeout;
+            timermcb.timer[index].expiry  = expiry;
+            timermcb.timer[index].period  = (timeout + TIMER_TICK_USEC - 1) / TIMER_TICK_USEC;
+            timermcb.timer[index].expires = timer_now () + timermcb.timer[index].period;
+
+            /* The first timer sets the next deadline. */
+            if (timermcb.num_active_timers == 0)
+                timermcb.next_dirty = TRUE;
+
+            timer_link (index);
 
             /* Increment the number of timers in the system */
             timermcb.num_active_timers++;
@@ -192,6 +385,81 @@ Int32 timer_add (Uint32 timeout, void (*expiry)(void))
     return -1;
 }
 
+/**
+ *  @b Description
+ *  @n  
+ *      The function restarts an active timer with a new timeout in 
+ *      micro-seconds. The timer expires after the new timeout and then
+ *      periodically with the new timeout.
+ *
+ *  @param[in]  handle
+ *      This is the handle to the timer block to be restarted.
+ *  @param[in]  timeout
+ *      This is the new timeout specified in micro-seconds.
+ *
+ *  @retval
+ *      Success  -  0
+ *  @retval
+ *      Error    -  <0
+ */
+Int32 timer_restart_usec (Int32 handle, Uint32 timeout)
+{
+    /* Basic Validations: Ensure parameters passed are valid. */
+    if ((handle < 0) || (handle >= MAX_TIMER_BLOCKS) || (timeout == 0))
+        return -1;
+
+    if (timermcb.timer[handle].expiry == NULL)
+        return -1;
+
+    timer_unlink (handle);
+    timermcb.timer[handle].period  = (timeout + TIMER_TICK_USEC - 1) / TIMER_TICK_USEC;
+    timermcb.timer[handle].expires = timer_now () + timermcb.timer[handle].period;
+    timer_link (handle);
+
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function returns a free running time in micro-seconds. The time 
+ *      is only kept while there are active timers, so it can only be used
+ *      to measure intervals while a timer is active. It wraps around after
+ *      2^32 micro-seconds.
+ *
+ *  @retval
+ *      Time in micro-seconds
+ */
+Uint32 timer_usec (void)
+{
+    if (timermcb.dev_active == FALSE)
+        return 0;
+
+    return ((Uint32)(dev_read_timer () * TIMER_TICK_USEC / timermcb.tick_counts));
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function creates a timer.
+ *
+ *  @param[in]  timeout
+ *      This is the timeout specified in milli-seconds after which the timer
+ *      will expire.
+ *  @param[in]  expiry
+ *      Expiration routine which is called to indicate that the timer block
+ *      has expired.
+ *
+ *  @retval
+ *      Success  -  Handle to the timer block
+ *  @retval
+ *      Error    -  <0
+ */
+Int32 timer_add (Uint32 timeout, void (*expiry)(void))
+{
+    return (timer_add_usec (timeout * 1000, expiry));
+}
+
 /**
  *  @b Description
  *  @n  
@@ -206,25 +474,139 @@ Int32 timer_add (Uint32 timeout, void (*expiry)(void))
 void timer_delete (Int32 handle)
 {
     /* Basic Validations: Ensure paramter is valid. */
-    if ((handle < 0) || (handle > MAX_TIMER_BLOCKS))
+    if ((handle < 0) || (handle >= MAX_TIMER_BLOCKS))
         return;
 
-    /* Make sure there is at least one timer which is active; */
-    if (timermcb.num_active_timers > 0)
+    /* Make sure the timer is active */
+    if (timermcb.timer[handle].expiry != NULL)
     {
+        timer_unlink (handle);
+
         /* Simply reset the memory contents */
         timerMemset ((void *)&timermcb.timer[handle], 0, sizeof(TIMER_BLOCK));
 
         /* Decrement the number of active timers in the system */
         timermcb.num_active_timers--;
 
-        /* Check if there are any active timers in the system? */
-        if (timermcb.num_active_timers == 0)
+        /* Check if there are any active timers in the system? The scheduler
+         * deletes the device timer itself once the expiration routines ran. */
+        if ((timermcb.num_active_timers == 0) && (timermcb.in_run == FALSE))
         {
             /* No more active timers; we can delete the timer in the device layer. */
             dev_delete_timer ();
+            timermcb.dev_active = FALSE;
+        }
+    }
+    return;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function returns the time left until the next timer expires.
+ *
+ *  @retval
+ *      Micro-seconds until the next timer expires, 0 if a timer is due
+ *  @retval
+ *      TIMER_NO_DEADLINE if there are no active timers
+ */
+Uint32 timer_next_deadline (void)
+{
+    unsigned long long count;
+
+    if (timermcb.num_active_timers == 0)
+        return (TIMER_NO_DEADLINE);
+
+    if (timermcb.next_dirty == TRUE)
+        timer_update_next ();
+
+    count = dev_read_timer ();
+    if (count >= timermcb.next_count)
+        return (0);
+
+    return ((Uint32)((timermcb.next_count - count) * TIMER_TICK_USEC / timermcb.tick_counts));
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function checks if the timer scheduler has work to do. Polling
+ *      loops use it to call timer_run only when a timer is due or a 
+ *      background task is active.
+ *
+ *  @retval
+ *      TRUE  - timer_run has work to do
+ *  @retval
+ *      FALSE - Nothing is due
+ */
+Bool timer_due (void)
+{
+    if (timermcb.num_active_tasks != 0)
+        return (TRUE);
+
+    if (timermcb.num_active_timers == 0)
+        return (FALSE);
+
+    if (timermcb.next_dirty == TRUE)
+        timer_update_next ();
+
+    return (dev_read_timer () >= timermcb.next_count);
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function adds a background task. The task is polled every time
+ *      the timer scheduler runs, so hardware bring up which is mostly waiting
+ *      progresses while the boot modules wait for their own devices.
+ *
+ *  @param[in]  poll
+ *      Poll routine of the task. It returns 0 once the task is complete,
+ *      after which it is no longer called.
+ *
+ *  @retval
+ *      Success  -  Handle to the task
+ *  @retval
+ *      Error    -  <0
+ */
+Int32 timer_task_add (Int32 (*poll)(void))
+{
+    Uint16  index;
+
+    /* Basic Validations: Ensure parameters passed are valid. */
+    if (poll == NULL)
+        return -1;
+
+    /* Cycle through and find a free task slot. */
+    for (index = 0; index < MAX_TIMER_TASKS; index++)
+    {
+        if (timermcb.task[index] == NULL)
+        {
+            timermcb.task[index] = poll;
+            timermcb.num_active_tasks++;
+            return index;
         }
     }
+
+    /* Control comes here indicating that there were no free task slots. */
+    return -1;
+}
+
+/**
+ *  @b Description
+ *  @n  
+ *      The function runs the timer scheduler until all the background
+ *      tasks are complete. It is called before anything which depends on
+ *      the result of the tasks.
+ *
+ *  @retval
+ *      Not Applicable.
+ */
+void timer_task_wait (void)
+{
+    while (timermcb.num_active_tasks != 0)
+        timer_run ();
+
     return;
 }
 
@@ -232,10 +614,11 @@ void timer_delete (Int32 handle)
  *  @b Description
  *  @n  
  *      The function runs the timer scheduler. This API is required to be 
- *      called by the boot modules and this in turn will decrement the various
- *      timer registered in the system and will call the appropriate
- *      expiration routines. If the boot modules fail to call this API then 
- *      the timers will never expire.
+ *      called by the boot modules and this in turn will call the expiration
+ *      routines of the timers which are due. Periodic timers are restarted
+ *      before their expiration routine is called. If the boot modules fail 
+ *      to call this API then the timers will never expire. The background 
+ *      tasks are polled on every call.
  *
  *  @retval
  *      Not Applicable.
@@ -243,39 +626,83 @@ void timer_delete (Int32 handle)
 void timer_run (void)
 {
     Uint16  index;
+    Uint32  now;
+    Uint32  tick;
+    Uint32  span;
+    Uint8   slot;
+    Uint8   cur;
+
+    /* Poll the background tasks. Completed tasks are removed. */
+    if (timermcb.num_active_tasks != 0)
+    {
+        for (index = 0; index < MAX_TIMER_TASKS; index++)
+        {
+            if ((timermcb.task[index] != NULL) && (timermcb.task[index]() == 0))
+            {
+                timermcb.task[index] = NULL;
+                timermcb.num_active_tasks--;
+            }
+        }
+    }
 
     /* Check if there are any active timers in the System or not? 
      * If none are present; then we dont need to run the scheduler. */
     if (timermcb.num_active_timers == 0)
         return;
 
-    /* Check if the device timer has expired or not? 
-     *  If the timer has not expired there is no management to be done. */
-    if (dev_check_timer() == FALSE)
+    /* Is the earliest timer due? If not there is no management to be done. */
+    if (timermcb.next_dirty == TRUE)
+        timer_update_next ();
+
+    if (dev_read_timer () < timermcb.next_count)
         return;
 
-    /* Cycle through all the timer blocks and update them. */
-    for (index = 0; index < MAX_TIMER_BLOCKS; index++)
+    /* Visit the wheel slots of the ticks which passed since the last run. 
+     * Each slot is visited at most once. */
+    now  = timer_now ();
+    span = now - timermcb.tick;
+    if (span > TIMER_WHEEL_SIZE)
+        span = TIMER_WHEEL_SIZE;
+
+    timermcb.in_run = TRUE;
+
+    for (tick = timermcb.tick + 1; span > 0; tick++, span--)
     {
-        /* Is this an active timer? */
-        if (timermcb.timer[index].expiry != NULL)
-        {
-            /* YES. Decrement the timeout. */
-            timermcb.timer[index].timeout = timermcb.timer[index].timeout - 100;
+        slot = tick & (TIMER_WHEEL_SIZE - 1);
 
-            /* Has the timer expired? */
-            if (timermcb.timer[index].timeout == 0)
+        /* The slot also holds timers of later turns of the wheel. The expiration 
+         * routines may add and delete timers, so the slot is walked from the
+         * start after each expiry. Restarted timers are no longer due. */
+        cur = timermcb.wheel[slot];
+        while (cur != TIMER_NIL)
+        {
+            if ((Int32)(timermcb.timer[cur].expires - now) > 0)
             {
-                /* Reset the timeouts */
-                timermcb.timer[index].timeout = timermcb.timer[index].org_timeout;
-
-                /* Call the expiration routine. */   
-                timermcb.timer[index].expiry();
+                cur = timermcb.timer[cur].next;
+                continue;
             }
 
+            /* Restart the timer */
+            timer_unlink (cur);
+            timermcb.timer[cur].expires = now + timermcb.timer[cur].period;
+            timer_link (cur);
+
+            /* Call the expiration routine. */
+            timermcb.timer[cur].expiry();
+
+            cur = timermcb.wheel[slot];
         }
     }
+
+    timermcb.tick   = now;
+    timermcb.in_run = FALSE;
+
+    /* The expiration routines may have deleted the last timer. */
+    if (timermcb.num_active_timers == 0)
+    {
+        dev_delete_timer ();
+        timermcb.dev_active = FALSE;
+    }
     return;
 }
 
-
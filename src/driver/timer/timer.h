@@ -42,6 +42,32 @@
 #ifndef __TIMER_H__
 #define __TIMER_H__
 
+/**
+ * @brief The maximum number of background tasks run by the timer scheduler
+ */
+#ifndef MAX_TIMER_TASKS
+#define MAX_TIMER_TASKS     2
+#endif
+
+/**
+ * @brief The resolution of the timers in micro-seconds
+ */
+#ifndef TIMER_TICK_USEC
+#define TIMER_TICK_USEC     100
+#endif
+
+/**
+ * @brief The number of slots in the timer wheel. Must be a power of 2.
+ */
+#ifndef TIMER_WHEEL_SIZE
+#define TIMER_WHEEL_SIZE    64
+#endif
+
+/**
+ * @brief The value returned by timer_next_deadline if there are no active timers
+ */
+#define TIMER_NO_DEADLINE   0xffffffff
+
 
 /**********************************************************************
  **************************** Exported Functions **********************
@@ -49,8 +75,15 @@
 
 extern void  timer_init(void);
 extern Int32 timer_add (Uint32 timeout, void (*expiry)(void));
+extern Int32 timer_add_usec (Uint32 timeout, void (*expiry)(void));
+extern Int32 timer_restart_usec (Int32 handle, Uint32 timeout);
+extern Uint32 timer_usec (void);
 extern void  timer_delete(Int32 handle);
 extern void  timer_run (void);
+extern Bool  timer_due (void);
+extern Uint32 timer_next_deadline (void);
+extern Int32 timer_task_add (Int32 (*poll)(void));
+extern void  timer_task_wait (void);
 
 #endif /* __TIMER_H__ */
 
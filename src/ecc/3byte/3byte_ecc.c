@@ -44,6 +44,7 @@
 /****************
  * Include Files
  ****************/
+#include <stdint.h>
 #include "types.h"
 #include "ecc.h"
 
@@ -70,11 +71,21 @@ static const Uint8 nand_ecc_table[] = {
 	0x00, 0x55, 0x56, 0x03, 0x59, 0x0c, 0x0f, 0x5a, 0x5a, 0x0f, 0x0c, 0x59, 0x03, 0x56, 0x55, 0x00
 };
 
+// Number of bits corrected by the last call to eccCorrectData
+static Int32 nand_ecc_corrected = 0;
+
+// Spreads a 4 bit value to the even bit positions of a byte
+static const Uint8 nand_ecc_spread[] = {
+	0x00, 0x01, 0x04, 0x05, 0x10, 0x11, 0x14, 0x15, 0x40, 0x41, 0x44, 0x45, 0x50, 0x51, 0x54, 0x55
+};
+
 /******************************************************************************
  * 
  * Function:	nandTransResult  
  *
- * Description:	Creates non-inverted ECC code from line parity
+ * Description:	Creates non-inverted ECC code from line parity. The bits of
+ * 				the two line parity registers are interleaved, reg 3 in the
+ * 				odd and reg 2 in the even bit positions.
  *
  * Parameters:	Uint8 uchReg2 - line parity reg 2
  * 				Uint8 uchReg3 - line parity reg 3
@@ -84,75 +95,163 @@ static const Uint8 nand_ecc_table[] = {
  ******************************************************************************/
 static void nandTransResult(Uint8 uchReg2, Uint8 uchReg3, Uint8 *puchEccCode)
 {
-	Uint8 a, b, i, tmp1, tmp2;
-
-	/* Initialize variables */
-	a = b = 0x80;
-	tmp1 = tmp2 = 0;
-
-	/* Calculate first ECC byte */
-	for (i = 0; i < 4; i++) {
-		if (uchReg3 & a)		/* LP15,13,11,9 --> ecc_code[0] */
-			tmp1 |= b;
-		b >>= 1;
-		if (uchReg2 & a)		/* LP14,12,10,8 --> ecc_code[0] */
-			tmp1 |= b;
-		b >>= 1;
-		a >>= 1;
-	}
+	/* LP15,13,11,9 and LP14,12,10,8 --> ecc_code[0] */
+	puchEccCode[0] = (nand_ecc_spread[uchReg3 >> 4] << 1) | nand_ecc_spread[uchReg2 >> 4];
 
-	/* Calculate second ECC byte */
-	b = 0x80;
-	for (i = 0; i < 4; i++) {
-		if (uchReg3 & a)		/* LP7,5,3,1 --> ecc_code[1] */
-			tmp2 |= b;
-		b >>= 1;
-		if (uchReg2 & a)		/* LP6,4,2,0 --> ecc_code[1] */
-			tmp2 |= b;
-		b >>= 1;
-		a >>= 1;
-	}
+	/* LP7,5,3,1 and LP6,4,2,0 --> ecc_code[1] */
+	puchEccCode[1] = (nand_ecc_spread[uchReg3 & 0x0f] << 1) | nand_ecc_spread[uchReg2 & 0x0f];
+}
+
+/******************************************************************************
+ * 
+ * Function:	nandWordParity  
+ *
+ * Description:	Returns 0x40 if the number of bits set in a word is odd,
+ * 				0 otherwise
+ *
+ * Parameters:	Uint32 uiWord - word
+ *
+ * Return Value: parity
+ ******************************************************************************/
+static Uint8 nandWordParity(Uint32 uiWord)
+{
+	uiWord ^= uiWord >> 16;
+	uiWord ^= uiWord >> 8;
 
-	/* Store two of the ECC bytes */
-	puchEccCode[0] = tmp1;
-	puchEccCode[1] = tmp2;
+	return (nand_ecc_table[uiWord & 0xff] & 0x40);
 }
+
 /******************************************************************************
  * 
- * Function:	eccComputeECC  
+ * Function:	nandLineParityBytes  
  *
- * Description:	Compute 3 byte ECC code for 256 byte block
+ * Description:	Computes the column parity and line parity of a 256 byte
+ * 				block one byte at a time
  *
  * Parameters:	Uint8* puchData - pointer to raw data
- * 				Uint8 *puchEccCode - pointer to ECC buffer
+ * 				Uint8 *puchReg1 - column parity
+ * 				Uint8 *puchReg3 - line parity of the odd parity bytes
  *
- * Return Value: status
+ * Return Value: void
  ******************************************************************************/
-Int32 eccComputeECC(const Uint8 *puchData, Uint8 *puchEccCode)
+static void nandLineParityBytes(const Uint8 *puchData, Uint8 *puchReg1, Uint8 *puchReg3)
 {
-	Uint8 uchIndex, uchReg1, uchReg2, uchReg3;
+	Uint8 uchIndex, uchReg1, uchReg3;
 	int j;
-	if(puchData == NULL || puchEccCode == NULL)
-		return ECC_FAIL;
-		
-	/* Initialize variables */
-	uchReg1 = uchReg2 = uchReg3 = 0;
-	puchEccCode[0] = puchEccCode[1] = puchEccCode[2] = 0;
+
+	uchReg1 = uchReg3 = 0;
 
 	/* Build up column parity */
 	for(j = 0; j < 256; j++) {
 
 		/* Get CP0 - CP5 from table */
 		uchIndex = nand_ecc_table[puchData[j]];
-		uchReg1 ^= (uchIndex & 0x3f);
+		uchReg1 ^= uchIndex;
 
 		/* All bit XOR = 1 ? */
-		if (uchIndex & 0x40) {
+		if (uchIndex & 0x40)
 			uchReg3 ^= (Uint8) j;
-			uchReg2 ^= ~((Uint8) j);
-		}
 	}
 
+	*puchReg1 = uchReg1;
+	*puchReg3 = uchReg3;
+}
+
+/******************************************************************************
+ * 
+ * Function:	nandLineParityWords  
+ *
+ * Description:	Computes the column parity and line parity of a word aligned
+ * 				256 byte block four words at a time. 
+ *
+ * 				The parity functions are linear, so the data is first
+ * 				folded with XOR. The column parity is the column parity of 
+ * 				the XOR of all the bytes. Line parity bit k is the parity of
+ * 				the XOR of all the bytes whose index has bit k set. Index 
+ * 				bits 2 to 7 select the word, bits 0 and 1 the byte within 
+ * 				the word, which is resolved through memory so the result 
+ * 				does not depend on the endianness.
+ *
+ * Parameters:	Uint8* puchData - pointer to raw data
+ * 				Uint8 *puchReg1 - column parity
+ * 				Uint8 *puchReg3 - line parity of the odd parity bytes
+ *
+ * Return Value: void
+ ******************************************************************************/
+static void nandLineParityWords(const Uint8 *puchData, Uint8 *puchReg1, Uint8 *puchReg3)
+{
+	const Uint32 *puiData = (const Uint32 *)puchData;
+	Uint32 w0, w1, w2, w3, uiSum;
+	Uint32 uiAll, uiLp0, uiLp1, uiLp2, uiLp3, uiLp4, uiLp5, uiLp6, uiLp7;
+	union {
+		Uint32 w;
+		Uint8  b[4];
+	} uLanes;
+	int i;
+
+	uiAll = uiLp0 = uiLp1 = uiLp2 = uiLp3 = uiLp4 = uiLp5 = uiLp6 = uiLp7 = 0;
+
+	for (i = 0; i < 64; i += 4) {
+		w0 = puiData[i];
+		w1 = puiData[i+1];
+		w2 = puiData[i+2];
+		w3 = puiData[i+3];
+
+		uiSum  = w0 ^ w1 ^ w2 ^ w3;
+		uiAll ^= uiSum;
+		uiLp2 ^= w1 ^ w3;
+		uiLp3 ^= w2 ^ w3;
+
+		if (i & 0x04)
+			uiLp4 ^= uiSum;
+		if (i & 0x08)
+			uiLp5 ^= uiSum;
+		if (i & 0x10)
+			uiLp6 ^= uiSum;
+		if (i & 0x20)
+			uiLp7 ^= uiSum;
+	}
+
+	/* Byte index bits 0 and 1 */
+	uLanes.w = uiAll;
+	uiLp0 = uLanes.b[1] ^ uLanes.b[3];
+	uiLp1 = uLanes.b[2] ^ uLanes.b[3];
+
+	*puchReg1 = nand_ecc_table[uLanes.b[0] ^ uLanes.b[1] ^ uLanes.b[2] ^ uLanes.b[3]];
+	*puchReg3 = (nandWordParity(uiLp0) >> 6)      | (nandWordParity(uiLp1) >> 5) |
+	            (nandWordParity(uiLp2) >> 4)      | (nandWordParity(uiLp3) >> 3) |
+	            (nandWordParity(uiLp4) >> 2)      | (nandWordParity(uiLp5) >> 1) |
+	            (nandWordParity(uiLp6))           | (nandWordParity(uiLp7) << 1);
+}
+
+/******************************************************************************
+ * 
+ * Function:	eccComputeECC  
+ *
+ * Description:	Compute 3 byte ECC code for 256 byte block. Word aligned
+ * 				blocks are processed a word at a time.
+ *
+ * Parameters:	Uint8* puchData - pointer to raw data
+ * 				Uint8 *puchEccCode - pointer to ECC buffer
+ *
+ * Return Value: status
+ ******************************************************************************/
+Int32 eccComputeECC(const Uint8 *puchData, Uint8 *puchEccCode)
+{
+	Uint8 uchReg1, uchReg2, uchReg3;
+
+	if(puchData == NULL || puchEccCode == NULL)
+		return ECC_FAIL;
+		
+	if (((Uint32)(uintptr_t)puchData & 3) == 0)
+		nandLineParityWords(puchData, &uchReg1, &uchReg3);
+	else
+		nandLineParityBytes(puchData, &uchReg1, &uchReg3);
+
+	/* Line parity reg 2 holds the complemented indexes of the odd parity 
+	 * bytes. There is an odd number of them if the whole block has odd parity */
+	uchReg2 = (uchReg1 & 0x40) ? ~uchReg3 : uchReg3;
+
 	/* Create non-inverted ECC code from line parity */
 	nandTransResult(uchReg2, uchReg3, puchEccCode);
 
@@ -180,6 +279,8 @@ Int32 eccCorrectData(Uint8 *puchData, Uint8 *puchEccRead, Uint8 *puchEccCalc)
 {
 	Uint8 a, b, c, d1, d2, d3, add, bit, i;
 	
+	nand_ecc_corrected = 0;
+
 	if(puchData == NULL || puchEccRead == NULL || puchEccCalc == NULL)
 		return ECC_FAIL;
 	
@@ -228,6 +329,7 @@ Int32 eccCorrectData(Uint8 *puchData, Uint8 *puchEccRead, Uint8 *puchEccCalc)
 			a = puchData[add];
 			a ^= (b << bit);
 			puchData[add] = a;
+			nand_ecc_corrected = 1;
 			return ECC_SUCCESS;
 		} else {
 			i = 0;
@@ -251,6 +353,7 @@ Int32 eccCorrectData(Uint8 *puchData, Uint8 *puchEccRead, Uint8 *puchEccCalc)
 				puchEccRead[0] = puchEccCalc[0];
 				puchEccRead[1] = puchEccCalc[1];
 				puchEccRead[2] = puchEccCalc[2];
+				nand_ecc_corrected = 1;
 				return ECC_SUCCESS;
 			}
 			else {
@@ -263,6 +366,14 @@ Int32 eccCorrectData(Uint8 *puchData, Uint8 *puchEccRead, Uint8 *puchEccCalc)
 
 
 
+/* The number of bits corrected by the last call to eccCorrectData */
+Int32 eccBitsCorrected(void)
+{
+    return (nand_ecc_corrected);
+
+}
+
+
 /* The number of bytes required for ecc */
 Int32 eccNumBytes(void)
 {
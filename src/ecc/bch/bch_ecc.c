@@ -0,0 +1,476 @@
+/******************************************************************************
+ * Copyright (c) 2010 Texas Instruments Incorporated - http://www.ti.com
+ * 
+ *  Redistribution and use in source and binary forms, with or without 
+ *  modification, are permitted provided that the following conditions 
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright 
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the 
+ *    documentation and/or other materials provided with the   
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+ 
+ 
+/******************************************************************************
+ *
+ * File Name:  	bch_ecc.c
+ *
+ * Description:	This file implements a binary BCH code over GF(2^13) which
+ * 				corrects up to BCH_ECC_T bit errors in each 512 byte block.
+ * 				The parity is computed a byte at a time from a remainder
+ * 				table built on first use. Decoding evaluates the syndromes
+ * 				on the parity difference, finds the error locator with
+ * 				Berlekamp-Massey and locates the errors with a Chien search.
+ *
+ * 				The ecc is stored inverted relative to the ecc of an erased
+ * 				block, so an erased page (all 0xff) reads back without errors.
+ *
+ *****************************************************************************/
+/****************
+ * Include Files
+ ****************/
+#include "types.h"
+#include "ecc.h"
+
+/*********************************
+ * Defines and Macros and globals
+ *********************************/
+/* Number of correctable bit errors per block. 4 and 8 are the usual choices.
+ * The SPI and GPIO nand drivers pack the ecc of every 512 byte block at the end
+ * of the spare area (7 bytes per block for t=4, 13 for t=8), and reject a layout
+ * where it covers a bad block marker. With the marker at spare byte 0 or 5:
+ *   512 byte page, 16 byte spare   - t=4 (spare bytes 9..15); t=8 covers byte 5
+ *   2048 byte page, 64 byte spare  - t=4 (36..63) and t=8 (12..63)
+ *   4096 byte page, 128 byte spare - t=4 (72..127) and t=8 (24..127) */
+#ifndef BCH_ECC_T
+ #define BCH_ECC_T          4
+#endif
+
+#if (BCH_ECC_T < 1) || (BCH_ECC_T > 8)
+ #error BCH_ECC_T must be in the range 1 to 8
+#endif
+
+#define BCH_M               13
+#define BCH_N               ((1 << BCH_M) - 1)
+#define BCH_POLY            0x201b                          /* x^13 + x^4 + x^3 + x + 1 */
+#define BCH_BLOCK_BYTES     512
+#define BCH_PARITY_BITS     (BCH_M * BCH_ECC_T)
+#define BCH_ECC_BYTES       ((BCH_PARITY_BITS + 7) >> 3)
+#define BCH_ECC_WORDS       ((BCH_PARITY_BITS + 31) >> 5)
+#define BCH_CODE_BITS       ((BCH_BLOCK_BYTES << 3) + BCH_PARITY_BITS)
+
+/* The parity register is kept left aligned, the highest degree term in the msb of word 0 */
+#define BCH_REG_BIT(pos)    (0x80000000u >> ((pos) & 31))
+
+/* Remainder of (v(x) * x^BCH_PARITY_BITS) mod g(x) for each byte value v */
+static Uint32 bchRemTable[256][BCH_ECC_WORDS];
+
+/* v * alpha^-8 for each byte value v, used to step the Chien search */
+static Uint16 bchChienTable[256];
+
+/* The ecc of an erased block, xor'd with 0xff */
+static Uint8  bchErasedEcc[BCH_ECC_BYTES];
+
+static Bool   bchReady = FALSE;
+
+/* Number of bits corrected by the last call to eccCorrectData */
+static Int32  bchCorrected = 0;
+
+
+/******************************************************************************
+ * 
+ * Function:	gfMul  
+ *
+ * Description:	Multiplies two elements of GF(2^13)
+ *
+ * Parameters:	Uint32 a, b - the field elements
+ *
+ * Return Value: a * b
+ ******************************************************************************/
+static Uint32 gfMul(Uint32 a, Uint32 b)
+{
+	Uint32 r = 0;
+
+	while (b)  {
+		if (b & 1)
+			r ^= a;
+
+		b >>= 1;
+		a <<= 1;
+		if (a & (1 << BCH_M))
+			a ^= BCH_POLY;
+	}
+
+	return (r);
+}
+
+/******************************************************************************
+ * 
+ * Function:	gfPow  
+ *
+ * Description:	Raises an element of GF(2^13) to a power
+ *
+ * Parameters:	Uint32 a - the field element
+ * 				Uint32 e - the exponent
+ *
+ * Return Value: a ^ e
+ ******************************************************************************/
+static Uint32 gfPow(Uint32 a, Uint32 e)
+{
+	Uint32 r = 1;
+
+	while (e)  {
+		if (e & 1)
+			r = gfMul(r, a);
+
+		a = gfMul(a, a);
+		e >>= 1;
+	}
+
+	return (r);
+}
+
+/******************************************************************************
+ * 
+ * Function:	bchShiftByte  
+ *
+ * Description:	Clocks one data byte through the parity register
+ *
+ * Parameters:	Uint32 *puiReg - the parity register
+ * 				Uint32 uiByte - the data byte
+ *
+ * Return Value: void
+ ******************************************************************************/
+static inline void bchShiftByte(Uint32 *puiReg, Uint32 uiByte)
+{
+	const Uint32 *puiRem;
+	int k;
+
+	puiRem = bchRemTable[(puiReg[0] >> 24) ^ uiByte];
+
+	for (k = 0; k < BCH_ECC_WORDS - 1; k++)
+		puiReg[k] = ((puiReg[k] << 8) | (puiReg[k+1] >> 24)) ^ puiRem[k];
+
+	puiReg[BCH_ECC_WORDS - 1] = (puiReg[BCH_ECC_WORDS - 1] << 8) ^ puiRem[BCH_ECC_WORDS - 1];
+}
+
+/******************************************************************************
+ * 
+ * Function:	bchInit  
+ *
+ * Description:	Builds the generator polynomial, which is the product of the
+ * 				minimal polynomials of alpha^1, alpha^3 .. alpha^(2t-1), then
+ * 				the byte remainder table and the erased block ecc
+ *
+ * Parameters:	none
+ *
+ * Return Value: void
+ ******************************************************************************/
+static void bchInit(void)
+{
+	Uint16 gen[BCH_PARITY_BITS + 1];
+	Uint32 gLow[BCH_ECC_WORDS];
+	Uint32 reg[BCH_ECC_WORDS];
+	Uint32 deg, i, c, a, v, bit, fb, pos;
+	int    k;
+
+	/* Multiply out (x + alpha^c) for every conjugate c of each odd power */
+	gen[0] = 1;
+	deg    = 0;
+
+	for (i = 1; i < 2 * BCH_ECC_T; i += 2)  {
+
+		/* Skip powers whose minimal polynomial was already included */
+		for (c = (i << 1) % BCH_N; c != i; c = (c << 1) % BCH_N)
+			if (c < i)
+				break;
+
+		if (c != i)
+			continue;
+
+		do  {
+			a = gfPow(2, c);
+
+			gen[deg + 1] = 0;
+			for (k = deg + 1; k > 0; k--)
+				gen[k] = gen[k-1] ^ gfMul(gen[k], a);
+			gen[0] = gfMul(gen[0], a);
+
+			deg = deg + 1;
+			c   = (c << 1) % BCH_N;
+		} while (c != i);
+	}
+
+	/* The coefficients are now binary. Drop the x^BCH_PARITY_BITS term */
+	for (k = 0; k < BCH_ECC_WORDS; k++)
+		gLow[k] = 0;
+
+	for (i = 0; i < BCH_PARITY_BITS; i++)  {
+		if (gen[i])  {
+			pos = BCH_PARITY_BITS - 1 - i;
+			gLow[pos >> 5] |= BCH_REG_BIT(pos);
+		}
+	}
+
+	/* Bit serial division of each byte value */
+	for (v = 0; v < 256; v++)  {
+
+		for (k = 0; k < BCH_ECC_WORDS; k++)
+			reg[k] = 0;
+
+		for (bit = 0x80; bit; bit >>= 1)  {
+
+			fb = (reg[0] >> 31) ^ ((v & bit) ? 1 : 0);
+
+			for (k = 0; k < BCH_ECC_WORDS - 1; k++)
+				reg[k] = (reg[k] << 1) | (reg[k+1] >> 31);
+			reg[BCH_ECC_WORDS - 1] <<= 1;
+
+			if (fb)
+				for (k = 0; k < BCH_ECC_WORDS; k++)
+					reg[k] ^= gLow[k];
+		}
+
+		for (k = 0; k < BCH_ECC_WORDS; k++)
+			bchRemTable[v][k] = reg[k];
+	}
+
+	/* Multiplying by alpha^-1 is a right shift, folding the polynomial in when the lsb is set */
+	for (v = 0; v < 256; v++)  {
+		a = v;
+		for (k = 0; k < 8; k++)
+			a = (a & 1) ? ((a ^ BCH_POLY) >> 1) : (a >> 1);
+		bchChienTable[v] = a;
+	}
+
+	/* The ecc of an erased block */
+	for (k = 0; k < BCH_ECC_WORDS; k++)
+		reg[k] = 0;
+
+	for (i = 0; i < BCH_BLOCK_BYTES; i++)
+		bchShiftByte(reg, 0xff);
+
+	for (k = 0; k < BCH_ECC_BYTES; k++)
+		bchErasedEcc[k] = ((reg[k >> 2] >> (24 - ((k & 3) << 3))) & 0xff) ^ 0xff;
+
+	bchReady = TRUE;
+}
+
+/******************************************************************************
+ * 
+ * Function:	eccComputeECC  
+ *
+ * Description:	Computes the BCH parity of a 512 byte block
+ *
+ * Parameters:	Uint8 *puchData - pointer to raw data
+ * 				Uint8 *puchEccCode - ecc (BCH_ECC_BYTES)
+ *
+ * Return Value: ECC_SUCCESS
+ ******************************************************************************/
+Int32 eccComputeECC(const Uint8 *puchData, Uint8 *puchEccCode)
+{
+	Uint32 reg[BCH_ECC_WORDS];
+	int    i, k;
+
+	if (bchReady == FALSE)
+		bchInit();
+
+	for (k = 0; k < BCH_ECC_WORDS; k++)
+		reg[k] = 0;
+
+	for (i = 0; i < BCH_BLOCK_BYTES; i++)
+		bchShiftByte(reg, puchData[i]);
+
+	for (k = 0; k < BCH_ECC_BYTES; k++)
+		puchEccCode[k] = ((reg[k >> 2] >> (24 - ((k & 3) << 3))) & 0xff) ^ bchErasedEcc[k];
+
+	return (ECC_SUCCESS);
+}
+
+/******************************************************************************
+ * 
+ * Function:	eccCorrectData  
+ *
+ * Description:	Detects and corrects up to BCH_ECC_T bit errors in a block.
+ * 				The difference of the two ecc values is the remainder of the
+ * 				error polynomial, so the syndromes are evaluated on it rather
+ * 				than on the data. Errors in the stored ecc are corrected in
+ * 				puchEccRead.
+ *
+ * Parameters:	Uint8 *puchData - pointer to raw data
+ * 				Uint8 *puchEccRead - ecc read from the spare area
+ * 				Uint8 *puchEccCalc - ecc calculated from the data
+ *
+ * Return Value: ECC_SUCCESS if the block is good or was corrected,
+ * 				 ECC_FAIL if the errors can not be corrected
+ ******************************************************************************/
+Int32 eccCorrectData(Uint8 *puchData, Uint8 *puchEccRead, Uint8 *puchEccCalc)
+{
+	Uint32 diff[BCH_ECC_WORDS];
+	Uint32 syn[2 * BCH_ECC_T + 1];
+	Uint32 lambda[2 * BCH_ECC_T + 1];
+	Uint32 prev[2 * BCH_ECC_T + 1];
+	Uint32 save[2 * BCH_ECC_T + 1];
+	Uint32 errPos[BCH_ECC_T];
+	Uint32 nErr, L, m, b, d, coef, a, s, i, j, pos, sum, found;
+	Uint32 uiNonZero;
+
+	bchCorrected = 0;
+
+	/* The parity remainder of the error pattern, pad bits excluded */
+	uiNonZero = 0;
+	for (i = 0; i < BCH_ECC_WORDS; i++)
+		diff[i] = 0;
+
+	for (i = 0; i < BCH_ECC_BYTES; i++)
+		diff[i >> 2] |= (Uint32)(puchEccRead[i] ^ puchEccCalc[i]) << (24 - ((i & 3) << 3));
+
+	if (BCH_PARITY_BITS & 31)
+		diff[BCH_ECC_WORDS - 1] &= ~(0xffffffffu >> (BCH_PARITY_BITS & 31));
+
+	for (i = 0; i < BCH_ECC_WORDS; i++)
+		uiNonZero |= diff[i];
+
+	if (uiNonZero == 0)
+		return (ECC_SUCCESS);
+
+	/* Syndromes. The odd ones by Horner's rule, S(2j) = S(j)^2 */
+	for (j = 1; j < 2 * BCH_ECC_T; j += 2)  {
+		a = gfPow(2, j);
+		s = 0;
+		for (pos = 0; pos < BCH_PARITY_BITS; pos++)
+			s = gfMul(s, a) ^ ((diff[pos >> 5] & BCH_REG_BIT(pos)) ? 1 : 0);
+		syn[j] = s;
+	}
+
+	for (j = 2; j <= 2 * BCH_ECC_T; j += 2)
+		syn[j] = gfMul(syn[j >> 1], syn[j >> 1]);
+
+	/* Berlekamp-Massey */
+	for (i = 0; i <= 2 * BCH_ECC_T; i++)
+		lambda[i] = prev[i] = 0;
+
+	lambda[0] = prev[0] = 1;
+	L = 0;
+	m = 1;
+	b = 1;
+
+	for (j = 0; j < 2 * BCH_ECC_T; j++)  {
+
+		d = syn[j + 1];
+		for (i = 1; i <= L; i++)
+			d ^= gfMul(lambda[i], syn[j + 1 - i]);
+
+		if (d == 0)  {
+			m = m + 1;
+			continue;
+		}
+
+		/* b^-1 = b^(2^13 - 2) */
+		coef = gfMul(d, gfPow(b, BCH_N - 1));
+
+		for (i = 0; i <= 2 * BCH_ECC_T; i++)
+			save[i] = lambda[i];
+
+		for (i = 0; i + m <= 2 * BCH_ECC_T; i++)
+			lambda[i + m] ^= gfMul(coef, prev[i]);
+
+		if (2 * L <= j)  {
+			L = j + 1 - L;
+			for (i = 0; i <= 2 * BCH_ECC_T; i++)
+				prev[i] = save[i];
+			b = d;
+			m = 1;
+		}  else
+			m = m + 1;
+	}
+
+	if (L > BCH_ECC_T)
+		return (ECC_FAIL);
+
+	/* Chien search. lambda[i] is stepped by alpha^-i for each bit position, so
+	 * a zero sum at step pos is an error at codeword bit degree pos. Writing
+	 * x = (x >> i) * alpha^i + low gives x * alpha^-i = (x >> i) + low * alpha^-i,
+	 * and low * alpha^-i is (low << (8 - i)) * alpha^-8 from the table */
+	nErr = L;
+	found = 0;
+
+	for (pos = 0; (pos < BCH_CODE_BITS) && (found < nErr); pos++)  {
+
+		sum = lambda[0];
+		for (i = 1; i <= nErr; i++)
+			sum ^= lambda[i];
+
+		if (sum == 0)
+			errPos[found++] = pos;
+
+		for (i = 1; i <= nErr; i++)
+			lambda[i] = (lambda[i] >> i) ^ bchChienTable[(lambda[i] << (8 - i)) & 0xff];
+	}
+
+	if (found != nErr)
+		return (ECC_FAIL);
+
+	for (i = 0; i < nErr; i++)  {
+
+		if (errPos[i] >= BCH_PARITY_BITS)  {
+			/* Data bit, the first data byte msb is the highest degree */
+			pos = BCH_CODE_BITS - 1 - errPos[i];
+			puchData[pos >> 3] ^= 0x80 >> (pos & 7);
+		}  else  {
+			/* Ecc Code Error Correction */
+			pos = BCH_PARITY_BITS - 1 - errPos[i];
+			puchEccRead[pos >> 3] ^= 0x80 >> (pos & 7);
+		}
+	}
+
+	bchCorrected = nErr;
+
+	return (ECC_SUCCESS);
+}
+
+
+/* The number of bits corrected by the last call to eccCorrectData */
+Int32 eccBitsCorrected(void)
+{
+    return (bchCorrected);
+
+}
+
+
+/* The number of bytes required for ecc */
+Int32 eccNumBytes(void)
+{
+    return (BCH_ECC_BYTES);
+
+}
+
+
+/* The number of bytes each ECC covers */
+Int32 eccBytesPerBlock (void)
+{
+    return (BCH_BLOCK_BYTES);
+
+}
+
@@ -0,0 +1,132 @@
+/******************************************************************************
+ * Copyright (c) 2010 Texas Instruments Incorporated - http://www.ti.com
+ * 
+ *  Redistribution and use in source and binary forms, with or without 
+ *  modification, are permitted provided that the following conditions 
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright 
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the 
+ *    documentation and/or other materials provided with the   
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+ 
+ 
+/******************************************************************************
+ *
+ * File Name:  	ecc.c
+ *
+ * Description:	Page level ecc handling common to all of the ecc algorithms.
+ * 				The ecc of all the blocks in a page is computed and compared
+ * 				in one pass; the per block correction is only run for the
+ * 				blocks whose ecc does not match.
+ *
+ *****************************************************************************/
+/****************
+ * Include Files
+ ****************/
+#include "types.h"
+#include "ecc.h"
+
+/*********************************
+ * Defines and Macros and globals
+ *********************************/
+/* The calculated ecc is held for this many bytes worth of blocks at a time */
+#define ECC_PAGE_CALC_BYTES     128
+
+
+/******************************************************************************
+ * 
+ * Function:	eccCorrectBlocks  
+ *
+ * Description:	Checks and corrects consecutive ecc blocks whose ecc values
+ * 				are stored consecutively
+ *
+ * Parameters:	Uint8 *puchData - the first block
+ * 				Int32 nBlocks - the number of blocks
+ * 				Uint8 *puchEccRead - ecc of the first block, read from the chip
+ * 				Uint32 *puiBitsCorrected - incremented by the number of bits
+ * 				                           corrected
+ *
+ * Return Value: The number of blocks corrected (0 if all are clean),
+ * 				 ECC_FAIL if any block can not be corrected. The blocks
+ * 				 after an uncorrectable one are still corrected.
+ ******************************************************************************/
+Int32 eccCorrectBlocks(Uint8 *puchData, Int32 nBlocks, Uint8 *puchEccRead, Uint32 *puiBitsCorrected)
+{
+	Uint8  uchEccCalc[ECC_PAGE_CALC_BYTES];
+	Uint8  uchDiff;
+	Int32  blockSize, eccBytes, nGroup;
+	Int32  nCorrected = 0;
+	Int32  failed = 0;
+	Int32  i, j;
+
+	blockSize = eccBytesPerBlock();
+	eccBytes  = eccNumBytes();
+
+	while (nBlocks > 0)  {
+
+		nGroup = ECC_PAGE_CALC_BYTES / eccBytes;
+		if (nGroup > nBlocks)
+			nGroup = nBlocks;
+
+		for (i = 0; i < nGroup; i++)
+			eccComputeECC(puchData + (i * blockSize), &uchEccCalc[i * eccBytes]);
+
+		/* Clean blocks are by far the common case */
+		uchDiff = 0;
+		for (j = 0; j < nGroup * eccBytes; j++)
+			uchDiff |= uchEccCalc[j] ^ puchEccRead[j];
+
+		if (uchDiff != 0)  {
+
+			for (i = 0; i < nGroup; i++)  {
+
+				uchDiff = 0;
+				for (j = 0; j < eccBytes; j++)
+					uchDiff |= uchEccCalc[(i * eccBytes) + j] ^ puchEccRead[(i * eccBytes) + j];
+
+				if (uchDiff == 0)
+					continue;
+
+				if (eccCorrectData(puchData + (i * blockSize), &puchEccRead[i * eccBytes], &uchEccCalc[i * eccBytes]) != ECC_SUCCESS)  {
+					failed = 1;
+					continue;
+				}
+
+				*puiBitsCorrected += eccBitsCorrected();
+				nCorrected = nCorrected + 1;
+			}
+		}
+
+		puchData    += nGroup * blockSize;
+		puchEccRead += nGroup * eccBytes;
+		nBlocks     -= nGroup;
+	}
+
+	if (failed)
+		return (ECC_FAIL);
+
+	return (nCorrected);
+}
+
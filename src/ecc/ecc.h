@@ -58,3 +58,5 @@ Int32 eccCorrectData(Uint8 *puchData, Uint8 *puchEccRead, Uint8 *puchEccCalc);
 Int32 eccComputeECC(const Uint8 *puchData, Uint8 *puchEccCode);
 Int32 eccNumBytes(void);
 Int32 eccBytesPerBlock (void);
+Int32 eccBitsCorrected (void);
+Int32 eccCorrectBlocks (Uint8 *puchData, Int32 nBlocks, Uint8 *puchEccRead, Uint32 *puiBitsCorrected);
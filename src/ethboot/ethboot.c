@@ -57,6 +57,7 @@
 #include "sgmii.h"
 #include "device.h"
 #include "mdioapi.h"
+#include "timer.h"
 #include <string.h>
 #include "net_osal.h"
 #include "cpsw_api.h"
@@ -115,7 +116,8 @@ void iblEthBoot (Int32 eIdx)
     void    (*exit)();
     uint8   buf[16];
     char    *ext;
-    unsigned int i,j;
+    uint32  linkPhyMask;
+    uint32  linkTimeoutMs;
 
     /* Power up the device. No action is taken if the device is already powered up */
     if (devicePowerPeriph (TARGET_PWR_ETH(ibl.bootModes[eIdx].port)) < 0) {
@@ -128,8 +130,22 @@ void iblEthBoot (Int32 eIdx)
                 ibl.mdioConfig.mdioClkDiv, ibl.mdioConfig.interDelay);
     }
 
-    for (j = 0; j < 0x100; j++)
-    	for (i = 0; i < 0x1000000; i++);
+    /* Wait for the phy to report link up. The background tasks, such as the
+     * DDR configuration, progress while waiting. An older config table leaves
+     * the link fields erased, which selects the defaults */
+    linkPhyMask   = ibl.ethLinkPhyMask;
+    linkTimeoutMs = ibl.ethLinkTimeoutMs;
+
+    if (linkPhyMask == 0xffffffff)
+        linkPhyMask = 0;
+
+    if ((linkTimeoutMs == 0) || (linkTimeoutMs == 0xffffffff))
+        linkTimeoutMs = MDIO_LINK_WAIT_DEFAULT_MSEC;
+
+    if (hwMdioLinkWait (linkPhyMask, ibl.mdioConfig.mdioClkDiv, linkTimeoutMs,
+                        ibl.pllConfig[ibl_MAIN_PLL].pllOutFreqMhz, &iblStatus.ethLinkWaitMs, timer_run) < 0)  {
+        iblStatus.ethLinkTimeouts += 1;
+    }
 
     /* SGMII configuration. If sgmii is not present this statement is defined
      * to void in target.h */
@@ -197,6 +213,14 @@ void iblEthBoot (Int32 eIdx)
     nDevice.send     = cpmac_drv_send;
     nDevice.receive  = cpmac_drv_receive;
 
+#ifdef TARGET_MAC_RCV_BURST
+    nDevice.receive_burst = cpmac_drv_receive_burst;
+    nDevice.release_burst = cpmac_drv_release_burst;
+#else
+    nDevice.receive_burst = NULL;
+    nDevice.release_burst = NULL;
+#endif
+
 
     /* have_params will be set to true in the tftp call back. It must be
      * set to false before opening the module, since the call back will
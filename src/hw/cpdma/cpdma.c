@@ -99,7 +99,7 @@ SINT16 hwCpdmaRxConfig (const cpdmaRxCfg_t *cfg)
                                        0,                       /* Retry on failure to transmit */
                                        CPDMA_DESC_TYPE_HOST,    /* Host type descriptor */
                                        0,                       /* PS located in descriptor */
-                                       0,                       /* SOP offset */
+                                       cfg->sopOffset,          /* SOP offset */
                                        cfg->qmNumRx,            /* Rx packet destination QM number */
                                        cfg->queueRx );          /* Rx packet destination queue */
 
@@ -21,6 +21,7 @@ typedef struct cpdmaRxCfg_s  {
     UINT32  qmNumRx;            /* Queue manager for received packets */
     UINT32  queueRx;            /* Default Rx queue for received packets */
     UINT32  tdownPollCount;     /* Number of loop iterations to wait for teardown */
+    UINT32  sopOffset;          /* Number of bytes skipped at the start of a receive buffer */
     
 } cpdmaRxCfg_t; 
 
@@ -11,6 +11,7 @@
 #include "emif4_api.h"
 #include "emif4_loc.h"
 #include "device.h"
+#include "tsc.h"
 
 #define CHIP_LEVEL_REG  0x02620000
 
@@ -110,20 +111,41 @@
 #endif
 
 
-static void ddr3_wait (uint32 del)
-{
-    volatile unsigned int i;
+/* The DDR3 initialization waits, in cpu cycles. The hardware init takes 600us.
+ * Automatic leveling needs at least 1048576 DDR clock cycles, 1.57ms, and takes
+ * around 10-15ms in practice. The waits were delay loops of 840336 + 1000000 and
+ * 4201680 + 2000000 iterations of a volatile counter and a nop, which take at least
+ * EMIF4_WAIT_LOOP_CYCLES each. The cycle counts keep at least that much time,
+ * about 16ms and 53ms at 1.4GHz */
+#ifndef EMIF4_WAIT_LOOP_CYCLES
+#define EMIF4_WAIT_LOOP_CYCLES      12
+#endif
 
-    for (i = 0; i < del; i++) asm (" nop ");
+#ifndef EMIF4_INIT_WAIT_CYCLES
+#define EMIF4_INIT_WAIT_CYCLES      ((840336 + 1000000) * EMIF4_WAIT_LOOP_CYCLES)
+#endif
+
+#ifndef EMIF4_LEVEL_WAIT_CYCLES
+#define EMIF4_LEVEL_WAIT_CYCLES     ((4201680 + 2000000) * EMIF4_WAIT_LOOP_CYCLES)
+#endif
 
-}
+/* The DDR3 initialization states */
+#define EMIF4_STATE_IDLE            0       /* No initialization in progress */
+#define EMIF4_STATE_INIT            1       /* Waiting for the hardware init */
+#define EMIF4_STATE_LEVEL           2       /* Waiting for automatic leveling */
+
+static SINT16 emif4State = EMIF4_STATE_IDLE;
+static UINT32 emif4Start;
+static UINT32 emif4Refresh;
 
 /*************************************************************************************************
  * FUNCTION PUROPSE: Initial EMIF4 setup
  *************************************************************************************************
- * DESCRIPTION: Emif configuration
+ * DESCRIPTION: Emif configuration. On the c66x devices the configuration is completed
+ *              by polling hwEmif4p0Poll, so the hardware init and leveling waits can
+ *              overlap other boot work.
  *************************************************************************************************/
-SINT16 hwEmif4p0Enable (iblEmif4p0_t *cfg)
+SINT16 hwEmif4p0Start (iblEmif4p0_t *cfg)
 {
     UINT32 v, i, TEMP;
     
@@ -235,28 +257,11 @@ SINT16 hwEmif4p0Enable (iblEmif4p0_t *cfg)
          TEMP |= PSIZE; // PAGESIZE bit field 2:0
          DDR_SDCFG = TEMP;
 
- 	/* assuming max device speed, 1.4GHz, 1 cycle = 0.714 ns *
-  	* so, 100 us = 100000 ns = 140056 cycles
-          thereby, 600us=840336 */
-         ddr3_wait(840336);             //Wait 600us for HW init to complete
-         ddr3_wait(1000000);
-
-        DDR_SDRFC = 0x00001450;       //Refresh rate = (7.8*666MHz]
-
-      /***************** 4.2.1 Partial automatic leveling ************/
-        DDR_RDWR_LVL_RMP_CTRL = 0x80000000; //enable automatic leveling
-   
-        /*Trigger automatic leveling - This ignores read DQS leveling result and uses ratio forced value
-          Wait for min 1048576 DDR clock cycles for leveling to complete = 1048576 * 1.5ns = 1572864ns = 1.57ms.
-          Actual time = ~10-15 ms */
-        DDR_RDWR_LVL_CTRL = 0x80000000; 
-
- 	/* assuming max device speed, 1.4GHz, 1 cycle = 0.714 ns *
-  	* so, 100 us = 100000 ns = 140056 cycles
-          thereby, 3ms=3000us=4201680 */
-	ddr3_wait(4201680); //Wait 3ms for leveling to complete
-    ddr3_wait(1000000);
-    ddr3_wait(1000000);
+         /* Wait for the HW init to complete. The refresh rate is set and
+          * automatic leveling is triggered from hwEmif4p0Poll */
+         emif4Refresh = 0x00001450;   //Refresh rate = (7.8*666MHz]
+         emif4Start   = TSCL;
+         emif4State   = EMIF4_STATE_INIT;
     }
     else if (v == DEVICE_C6657_JTAG_ID_VAL)
     {
@@ -354,26 +359,11 @@ SINT16 hwEmif4p0Enable (iblEmif4p0_t *cfg)
         TEMP |= 0x2; // PAGESIZE bit field 2:0
         DDR_SDCFG = TEMP;
 
- 	/* assuming max device speed, 1.4GHz, 1 cycle = 0.714 ns *
-  	* so, 100 us = 100000 ns = 140056 cycles
-          thereby, 600us=840336 */
-         ddr3_wait(840336);             //Wait 600us for HW init to complete
-
-        DDR_SDRFC = 0x0000144F;       //Refresh rate = (7.8*666MHz]
-
-      /***************** 4.2.1 Partial automatic leveling ************/
-        DDR_RDWR_LVL_RMP_CTRL = 0x80000000; //enable automatic leveling
-   
-        /*Trigger automatic leveling - This ignores read DQS leveling result and uses ratio forced value
-          Wait for min 1048576 DDR clock cycles for leveling to complete = 1048576 * 1.5ns = 1572864ns = 1.57ms.
-          Actual time = ~10-15 ms */
-        DDR_RDWR_LVL_CTRL = 0x80000000; 
-
- 	/* assuming max device speed, 1.4GHz, 1 cycle = 0.714 ns *
-  	* so, 100 us = 100000 ns = 140056 cycles
-          thereby, 3ms=3000us=4201680 */
-	ddr3_wait(4201680); //Wait 3ms for leveling to complete
-    
+         /* Wait for the HW init to complete. The refresh rate is set and
+          * automatic leveling is triggered from hwEmif4p0Poll */
+         emif4Refresh = 0x0000144F;   //Refresh rate = (7.8*666MHz]
+         emif4Start   = TSCL;
+         emif4State   = EMIF4_STATE_INIT;
     }		
     else
     {
@@ -468,6 +458,62 @@ SINT16 hwEmif4p0Enable (iblEmif4p0_t *cfg)
     
     return (0);
 
+} /* hwEmif4p0Start */
+
+
+/*************************************************************************************************
+ * FUNCTION PUROPSE: Complete the EMIF4 setup
+ *************************************************************************************************
+ * DESCRIPTION: Advances the DDR3 initialization once each wait has elapsed. After the
+ *              hardware init the refresh rate is set and automatic leveling is triggered.
+ *              Returns 1 while the initialization is in progress, 0 once it is complete.
+ *************************************************************************************************/
+SINT16 hwEmif4p0Poll (void)
+{
+    switch (emif4State)  {
+
+        case EMIF4_STATE_INIT:
+            if ((TSCL - emif4Start) < EMIF4_INIT_WAIT_CYCLES)
+                return (1);
+
+            DDR_SDRFC = emif4Refresh;
+
+            /***************** 4.2.1 Partial automatic leveling ************/
+            DDR_RDWR_LVL_RMP_CTRL = 0x80000000; //enable automatic leveling
+
+            /* Trigger automatic leveling - This ignores read DQS leveling result and uses ratio forced value */
+            DDR_RDWR_LVL_CTRL = 0x80000000;
+
+            emif4Start = TSCL;
+            emif4State = EMIF4_STATE_LEVEL;
+            return (1);
+
+        case EMIF4_STATE_LEVEL:
+            if ((TSCL - emif4Start) < EMIF4_LEVEL_WAIT_CYCLES)
+                return (1);
+
+            emif4State = EMIF4_STATE_IDLE;
+            break;
+    }
+
+    return (0);
+
+} /* hwEmif4p0Poll */
+
+
+/*************************************************************************************************
+ * FUNCTION PUROPSE: EMIF4 setup
+ *************************************************************************************************
+ * DESCRIPTION: The emif is configured and the initialization waited for
+ *************************************************************************************************/
+SINT16 hwEmif4p0Enable (iblEmif4p0_t *cfg)
+{
+    hwEmif4p0Start (cfg);
+
+    while (hwEmif4p0Poll () != 0);
+
+    return (0);
+
 } /* hwEmif4p0Enable */
 
 
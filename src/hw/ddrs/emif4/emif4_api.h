@@ -13,6 +13,8 @@
 
 
 SINT16 hwEmif4p0Enable (iblEmif4p0_t *cfg);
+SINT16 hwEmif4p0Start (iblEmif4p0_t *cfg);
+SINT16 hwEmif4p0Poll (void);
 
 
 
@@ -46,6 +46,9 @@
 #define EMIF25_FLASH_ERR_ADDR_REG(x)  (0xd0 + (x)*4)
 #define EMIF25_FLASH_ERR_VALUE_REG(x) (0xd8 + (x)*4)
 
+/* The raw state of the wait pin 0 in the flash status register. High if the nand is ready */
+#define EMIF25_FLASH_STATUS_WAIT0     0x01
+
 /* Setting the bus width in the async config register */
 #define EMIF25_SET_ASYNC_WID(x,v)     BOOT_SET_BITFIELD((x),(v),1,0)
 
@@ -52,6 +52,8 @@
 Int32 cpmac_drv_start (NET_DRV_DEVICE* ptr_device);
 Int32 cpmac_drv_send (NET_DRV_DEVICE* ptr_device, Uint8* buffer, int num_bytes);
 Int32 cpmac_drv_receive (NET_DRV_DEVICE* ptr_device, Uint8* buffer);
+Int32 cpmac_drv_receive_burst (NET_DRV_DEVICE* ptr_device, Uint8** buffer, Int32* num_bytes, Int32 max_pkts);
+void  cpmac_drv_release_burst (NET_DRV_DEVICE* ptr_device);
 Int32 cpmac_drv_stop (NET_DRV_DEVICE* ptr_device);
 
 
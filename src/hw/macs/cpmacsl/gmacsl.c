@@ -132,6 +132,22 @@ Int32 cpmac_drv_receive (NET_DRV_DEVICE* ptr_device, Uint8* buffer)
 }
 
 
+#ifdef TARGET_MAC_RCV_BURST
+Int32 cpmac_drv_receive_burst (NET_DRV_DEVICE* ptr_device, Uint8** buffer, Int32* num_bytes, Int32 max_pkts)
+{
+   return (targetMacRcvBurst ((void *)ptr_device, buffer, num_bytes, max_pkts));
+
+}
+
+
+void cpmac_drv_release_burst (NET_DRV_DEVICE* ptr_device)
+{
+   targetMacRcvRelease ((void *)ptr_device);
+
+}
+#endif
+
+
 Int32 cpmac_drv_stop (NET_DRV_DEVICE* ptr_device)
 {
 
@@ -51,6 +51,9 @@
 #include "types.h"
 #include "mdio.h"
 #include "device.h"
+#include "tsc.h"
+#include "mdioapi.h"
+
 
 /***********************************************************************************
  * FUNCTION PURPOSE: Provide an approximate delay
@@ -97,6 +100,73 @@ void hwMdio (int16 nAccess, uint32 *access, uint16 clkdiv, uint32 delayCpuCycles
 }
 
 
+/***********************************************************************************
+ * FUNCTION PURPOSE: Wait for the phy link
+ ***********************************************************************************
+ * DESCRIPTION: The mdio state machine polls the phys on the bus and reflects
+ *              their link state in the LINK register. The function returns as
+ *              soon as a phy in phyMask reports link up, or any phy if phyMask
+ *              is 0. If no phy answers on the bus there is no link to wait for.
+ *              The time waited is returned in waitMs. The idle function, if not
+ *              NULL, is called while waiting. Returns 0 if the link is up, -1 if
+ *              it did not come up in timeoutMs.
+ ***********************************************************************************/
+int16 hwMdioLinkWait (uint32 phyMask, uint16 clkdiv, uint32 timeoutMs, uint32 cpuFreqMhz, uint32 *waitMs, void (*idle)(void))
+{
+    uint32 cyclesPerMs;
+    uint32 cycles;
+    uint32 last;
+    uint32 now;
+
+    /* Enable MDIO if the configuration has not */
+    if ((MDIOR->CONTROL & 0x40000000) == 0)  {
+        if (clkdiv == 0)
+            clkdiv = 1;
+
+        MDIOR->CONTROL = (0x40000000 | clkdiv);
+    }
+
+    if (phyMask == 0)
+        phyMask = 0xffffffff;
+
+    /* Assume 1 GHz if the cpu frequency is not known */
+    if (cpuFreqMhz == 0)
+        cpuFreqMhz = 1000;
+
+    cyclesPerMs = cpuFreqMhz * 1000;
+    cycles      = 0;
+    *waitMs     = 0;
+
+    last = TSCL;
+
+    for (;;)  {
+
+        if ((MDIOR->LINK & phyMask) != 0)
+            return (0);
+
+        if ((MDIOR->ALIVE == 0) && (*waitMs >= MDIO_ALIVE_WAIT_MSEC))
+            return (0);
+
+        if (*waitMs >= timeoutMs)
+            return (-1);
+
+        if (idle != NULL)
+            (*idle)();
+
+        /* The elapsed time is accumulated so the 32 bit counter can wrap */
+        now     = TSCL;
+        cycles += now - last;
+        last    = now;
+
+        while (cycles >= cyclesPerMs)  {
+            cycles  -= cyclesPerMs;
+            *waitMs += 1;
+        }
+    }
+
+}
+
+
 
 
 
@@ -50,7 +50,19 @@
  *	The MDIO api is defined
  **************************************************************************************/
  
+
+/* The time to wait for the phy link if the configuration does not specify it */
+#ifndef MDIO_LINK_WAIT_DEFAULT_MSEC
+ #define MDIO_LINK_WAIT_DEFAULT_MSEC    5000
+#endif
+
+/* The time allowed for the mdio state machine to find the phys on the bus */
+#ifndef MDIO_ALIVE_WAIT_MSEC
+ #define MDIO_ALIVE_WAIT_MSEC           20
+#endif
+
 void hwMdio (int16 nAccess, uint32 *access, uint16 clkdiv, uint32 delayCpuCycles);
+int16 hwMdioLinkWait (uint32 phyMask, uint16 clkdiv, uint32 timeoutMs, uint32 cpuFreqMhz, uint32 *waitMs, void (*idle)(void));
 
 
 
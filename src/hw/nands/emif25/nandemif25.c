@@ -42,19 +42,26 @@
 #include "ecc.h"
 #include "target.h"
 #include "uart.h"
+#include "tsc.h"
 
 #define NAND_DATA_OFFSET    0x0     /* Data register offset */
 #define NAND_ALE_OFFSET     0x2000  /* Address latch enable register offset */
 #define NAND_CMD_OFFSET     0x4000  /* Command latch enable register offset */
 
 #define NAND_DELAY          50000
+#define NAND_TWB_DELAY      200     /* Time for the device to signal busy after a command */
 #define EMIF16_NAND_PROG_TIMEOUT           (100000)
 
+/* The register accessors can be replaced by a host test (util/ecc-test) */
+#ifndef DEVICE_REG8_W
 #define DEVICE_REG8_W(x,y)  *(volatile Uint8 *)(x)=(y)
 #define DEVICE_REG8_R(x)    (*(volatile Uint8 *)(x))
+#endif
 
+#ifndef DEVICE_REG16_W
 #define DEVICE_REG16_W(x,y) *(volatile Uint16 *)(x)=(y)
 #define DEVICE_REG16_R(x)   (*(volatile Uint16 *)(x))
+#endif
 
 extern void chipDelay32 (uint32 del);
 extern uint32 deviceEmif25MemBase (int32 cs);
@@ -103,6 +110,7 @@ NandRead4bitECC
 
 /* Correct up to 4 bits in data we just read, using state left in the
 * hardware plus the ecc_code computed when it was first written.
+* Returns the number of bits corrected, or -1 if the data can't be corrected.
 */
 static Int32
 NandCorrect4bitECC
@@ -207,13 +215,61 @@ correct:
 
         if (error_address < 512) {
             data[error_address] ^= error_value;
-            corrected++;
+
+            /* Count the corrected bits */
+            for (error_value &= 0xff; error_value != 0; error_value &= error_value - 1)
+                corrected++;
         }
     }
 
     return corrected;
 }
 
+/**
+ *  @brief
+ *      Wait for the nand to become ready after a command. The wait pin is polled,
+ *      NAND_DELAY is only used as a timeout. The time spent is recorded in the 
+ *      ibl status.
+ */
+static void nandWaitReady (void)
+{
+    Uint32 i;
+    Uint32 start;
+
+    start = TSCL;
+
+    /* The device takes tWB to pull the ready/busy line low */
+    chipDelay32 (NAND_TWB_DELAY);
+
+    for (i = 0; i < NAND_DELAY; i++)  {
+        if ((DEVICE_REG32_R (DEVICE_EMIF25_BASE + EMIF25_FLASH_STATUS_REG) & EMIF25_FLASH_STATUS_WAIT0) != 0)
+            break;
+    }
+
+    if (i == NAND_DELAY)
+        iblStatus.nandReadyTimeouts += 1;
+
+    iblStatus.nandReadyCycles = TSCL - start;
+}
+
+/**
+ *  @brief
+ *      Record the bits corrected in an ecc block in the ibl status
+ */
+static void nandEccCount (Int32 nCorrected)
+{
+    if (nCorrected > 0)  {
+        iblStatus.nandEccCorrectedBits   += nCorrected;
+        iblStatus.nandEccCorrectedBlocks += 1;
+    }
+}
+
+/**
+ *  @brief
+ *      Read data from the nand data register. For word aligned buffers the data 
+ *      is read 32 bits at a time; the EMIF packs the accesses to the 8 or 16 bit 
+ *      bus into each word. The remaining bytes are read at the bus width.
+ */
 void 
 nandReadDataBytes
 (
@@ -222,7 +278,28 @@ nandReadDataBytes
 )
 {
     Int32   i;
+    Int32   nwords;
     Uint16  *data16;
+    Uint32  *data32;
+
+    if ((((Uint32)(uintptr_t)data & 3) == 0) && (nbytes >= 4))
+    {
+        data32 = (Uint32 *)data;
+        nwords = nbytes >> 2;
+
+        for (i = 0; i <= nwords - 4; i += 4)  {
+            data32[i]   = DEVICE_REG32_R(memBase);
+            data32[i+1] = DEVICE_REG32_R(memBase);
+            data32[i+2] = DEVICE_REG32_R(memBase);
+            data32[i+3] = DEVICE_REG32_R(memBase);
+        }
+
+        for ( ; i < nwords; i++)
+            data32[i] = DEVICE_REG32_R(memBase);
+
+        data   = data   + (nwords << 2);
+        nbytes = nbytes - (nwords << 2);
+    }
 
     if (hwDevInfo->busWidthBits == 8)  
     {
@@ -250,7 +327,7 @@ Int32 nandHwEmifDriverInit (int32 cs, void *vdevInfo)
     memBase   = deviceEmif25MemBase (cs);
 
     nandCmdSet(hwDevInfo->resetCommand);
-    chipDelay32 (NAND_DELAY);
+    nandWaitReady ();
 
     return (0);
 }
@@ -301,7 +378,7 @@ Int32 nandHwEmifDriverReadBytes (Uint32 block, Uint32 page, Uint32 byte, Uint32
     nandAleSet((addr >> 25) & 0x1);     /* A25-A26 4th Cycle, plane addr        */
 #endif
 
-    chipDelay32 (NAND_DELAY);
+    nandWaitReady ();
     nandReadDataBytes(nbytes, data);
     return (0);
 }
@@ -320,6 +397,7 @@ Int32 nandHwEmifDriverReadPage (Uint32 block, Uint32 page, Uint8 *data)
     Uint32  v;
     Uint32  byte = 0;
     Uint8 iIteration;
+    Int32   nCorrected;
     
 #ifdef NAND_TYPE_LARGE
     /* Read the spare area data */
@@ -342,7 +420,7 @@ Int32 nandHwEmifDriverReadPage (Uint32 block, Uint32 page, Uint8 *data)
     if(hwDevInfo->postCommand)
           nandCmdSet(hwDevInfo->readCommandPost); // Second cycle send post command
     
-    chipDelay32 (NAND_DELAY);
+    nandWaitReady ();
     /* Start 4-bit ECC calculation */
     v = DEVICE_REG32_R (DEVICE_EMIF25_BASE + EMIF25_FLASH_CTL_REG);
     DEVICE_REG32_W (DEVICE_EMIF25_BASE + EMIF25_FLASH_CTL_REG, v | (1<<12));
@@ -363,10 +441,12 @@ Int32 nandHwEmifDriverReadPage (Uint32 block, Uint32 page, Uint8 *data)
 
         eccFlash[i] = pSpareArea[hwDevInfo->eccBytesIdx[i]];
     }
-      if (NandCorrect4bitECC(data, eccFlash) < 0) {
+      nCorrected = NandCorrect4bitECC(data, eccFlash);
+      if (nCorrected < 0) {
     
         return (NAND_ECC_FAILURE);
     }
+      nandEccCount (nCorrected);
 	data += 512;
 	byte += 512;
 
@@ -383,7 +463,7 @@ Int32 nandHwEmifDriverReadPage (Uint32 block, Uint32 page, Uint8 *data)
     nandAleSet((addr >> 9) & 0xFF);     /* A9-A16  2nd Cycle, page addr & blk   */
     nandAleSet((addr >> 17) & 0xFF);    /* A17-A24 3rd Cycle, block addr        */
     nandAleSet((addr >> 25) & 0x1);     /* A25-A26 4th Cycle, plane addr        */
-    chipDelay32 (NAND_DELAY);
+    nandWaitReady ();
     /* Start 4-bit ECC calculation */
     v = DEVICE_REG32_R (DEVICE_EMIF25_BASE + EMIF25_FLASH_CTL_REG);
     DEVICE_REG32_W (DEVICE_EMIF25_BASE + EMIF25_FLASH_CTL_REG, v | (1<<12));
@@ -406,10 +486,12 @@ Int32 nandHwEmifDriverReadPage (Uint32 block, Uint32 page, Uint8 *data)
         eccFlash[i] = pSpareArea[hwDevInfo->eccBytesIdx[i]];
     }
     
-    if (NandCorrect4bitECC(data, eccFlash) < 0)
+    nCorrected = NandCorrect4bitECC(data, eccFlash);
+    if (nCorrected < 0)
     {
         return (NAND_ECC_FAILURE);
     }
+    nandEccCount (nCorrected);
 #endif
     return (0);
 
@@ -56,9 +56,9 @@
 #include "ecc.h"
 #include "target.h"
 #include "nandgpioloc.h"
+#include "tsc.h"
 
 /* Pointer to the device configuration */
-extern volatile cregister Uint32 TSCL;
 nandDevInfo_t *hwDevInfo;
 
 /**
@@ -203,6 +203,8 @@ Int32 nandHwGpioDriverInit (int32 cs, void *vdevInfo)
 {
 	Uint32 cmd;
 	Uint32 ret;
+	Int32  eccStart;
+	Int32  i;
 
 	nandDevInfo_t *devInfo = (nandDevInfo_t *)vdevInfo;
 
@@ -211,6 +213,20 @@ Int32 nandHwGpioDriverInit (int32 cs, void *vdevInfo)
 	if (devInfo->addressBytes > 4)
 		return (NAND_INVALID_ADDR_SIZE);
 
+	/* The packed codes (other than the 3 byte hamming code) fill the end of the spare
+	 * area. A layout in which they do not fit or cover a bad block marker would show
+	 * good blocks as bad, so it is rejected */
+	if (eccBytesPerBlock() != ECC_BLOCK_SIZE)  {
+		eccStart = (Int32)devInfo->pageEccBytes - 
+		           (Int32)(devInfo->pageSizeBytes / eccBytesPerBlock()) * eccNumBytes();
+		if (eccStart < 0)
+			return (NAND_INVALID_ECC_LAYOUT);
+
+		for (i = 0; i < ibl_N_BAD_BLOCK_PAGE; i++)
+			if ((devInfo->badBlkMarkIdx[i] >= eccStart) && (devInfo->badBlkMarkIdx[i] < devInfo->pageEccBytes))
+				return (NAND_INVALID_ECC_LAYOUT);
+	}
+
 	// Initialize NAND interface
 	ptNandConfig();
 	ndelay(TARGET_NAND_STD_DELAY*10);	
@@ -368,9 +384,36 @@ Int32 nandHwGpioDriverReadPage(Uint32 block, Uint32 page, Uint8 *data)
     if (ret < 0)
         return (ret);
 
+    /* Codes other than the 3 byte hamming code (the BCH code) are packed at the end
+     * of the spare area, the last block's ecc last, the same as the SPI driver */
+    if (eccBytesPerBlock() != ECC_BLOCK_SIZE)  {
+
+        i = hwDevInfo->pageSizeBytes / eccBytesPerBlock();
+
+        iErrors = eccCorrectBlocks (data, i, SpareAreaBuf + hwDevInfo->pageEccBytes - (i * eccNumBytes()),
+                                    &iblStatus.nandEccCorrectedBits);
+        if (iErrors < 0)
+            return (NAND_ECC_FAILURE);
+
+        iblStatus.nandEccCorrectedBlocks += iErrors;
+        return (0);
+    }
+
     /* Perform ECC on 256 byte blocks. Three bytes of ecc per 256 byte block are used. The last
      * 3 bytes are used for the last block, the previous three for the block before that, etc */
 
+	if (hwDevInfo->pageSizeBytes == 2048) {
+		/* Correct ecc error for each 256 byte blocks. The ecc values are consecutive
+		 * so they are all checked before any correction is attempted */
+		iErrors = eccCorrectBlocks(data, hwDevInfo->pageSizeBytes / ECC_BLOCK_SIZE,
+			SpareAreaBuf + 40, &iblStatus.nandEccCorrectedBits);
+		if (iErrors < 0)
+			return (NAND_ECC_FAILURE);
+
+		iblStatus.nandEccCorrectedBlocks += iErrors;
+		return (0);
+	}
+
 	for(i = 0; i < hwDevInfo->pageSizeBytes / ECC_BLOCK_SIZE; i++)
 	{
 		
@@ -391,11 +434,11 @@ Int32 nandHwGpioDriverReadPage(Uint32 block, Uint32 page, Uint8 *data)
 				iErrors = eccCorrectData(data + (i * ECC_BLOCK_SIZE), 
 					tempSpareAreaBuf, eccCalc);
 			}
-		} else if (hwDevInfo->pageSizeBytes == 2048) {
-			/* Correct ecc error for each 256 byte blocks */
-			eccComputeECC(data + i * ECC_BLOCK_SIZE, eccCalc);
-			iErrors = eccCorrectData(data + (i * ECC_BLOCK_SIZE),
-				(SpareAreaBuf + 40 + (i * 3)), eccCalc);
+
+			if ((iErrors == ECC_SUCCESS) && (eccBitsCorrected() > 0))  {
+				iblStatus.nandEccCorrectedBits   += eccBitsCorrected();
+				iblStatus.nandEccCorrectedBlocks += 1;
+			}
 		}
 	}
 
@@ -58,6 +58,7 @@
 #define NAND_ECC_FAILURE            -813
 #define NAND_INVALID_CS             -814
 #define NAND_READ_FAILURE           -815
+#define NAND_INVALID_ECC_LAYOUT     -816
 
 
 /* Information used only for programming flash */
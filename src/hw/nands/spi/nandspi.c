@@ -52,6 +52,19 @@ Int32 nandHwSpiDriverInit (int32 cs, void *vdevInfo)
 {
 
     nandDevInfo_t *devInfo = (nandDevInfo_t *)vdevInfo;
+    Int32 eccStart;
+    Int32 i;
+
+    /* The ecc is packed at the end of the spare area. It must fit and must not
+     * cover a bad block marker, otherwise good blocks would show up as bad */
+    eccStart = (Int32)devInfo->pageEccBytes - 
+               (Int32)(devInfo->pageSizeBytes / eccBytesPerBlock ()) * eccNumBytes ();
+    if (eccStart < 0)
+        return (NAND_INVALID_ECC_LAYOUT);
+
+    for (i = 0; i < ibl_N_BAD_BLOCK_PAGE; i++)
+        if ((devInfo->badBlkMarkIdx[i] >= eccStart) && (devInfo->badBlkMarkIdx[i] < devInfo->pageEccBytes))
+            return (NAND_INVALID_ECC_LAYOUT);
 
     hwSpiDevInfo = devInfo;
 
@@ -86,11 +99,8 @@ Int32 nandHwSpiDriverReadBytes (Uint32 block, Uint32 page, Uint32 byte, Uint32 n
  */
 Int32 nandHwSpiDriverReadPage (Uint32 block, Uint32 page, Uint8 *data)
 {
-    Int32   i;
     Int32   nSegs;
-    Uint8  *blockp;
-    Uint8  *eccp;
-    Uint8   eccCalc[3];
+    Int32   nCorrected;
 
 
     /* Read the entire page, including the extra bytes. The array data
@@ -100,19 +110,18 @@ Int32 nandHwSpiDriverReadPage (Uint32 block, Uint32 page, Uint8 *data)
 
 
 
-    /* Break the page into segments of 256 bytes for ECC correction */
-    nSegs = hwSpiDevInfo->pageSizeBytes >> 8;
-
-    for (i = 0; i < nSegs; i++)  {
+    /* Break the page into segments for ECC correction. The ecc for the last
+     * segment is at the end of the spare area, the one before it precedes it, etc.
+     * The ecc of every segment is checked before any correction is attempted */
+    nSegs = hwSpiDevInfo->pageSizeBytes / eccBytesPerBlock ();
 
-        blockp = &data[i << 8];
-        eccp   = &data[hwSpiDevInfo->pageSizeBytes + hwSpiDevInfo->pageEccBytes - ((nSegs - i) * 3)];
-        eccComputeECC (blockp, eccCalc);
+    nCorrected = eccCorrectBlocks (data, nSegs, &data[hwSpiDevInfo->pageSizeBytes + hwSpiDevInfo->pageEccBytes - (nSegs * eccNumBytes ())],
+                                   &iblStatus.nandEccCorrectedBits);
 
-        if (eccCorrectData (blockp, eccp, eccCalc) != ECC_SUCCESS)
-            return (NAND_ECC_FAILURE);
+    if (nCorrected < 0)
+        return (NAND_ECC_FAILURE);
 
-    }
+    iblStatus.nandEccCorrectedBlocks += nCorrected;
 
     return (0);
 
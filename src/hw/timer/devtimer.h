@@ -54,9 +54,10 @@
 #include "types.h"
 #include "devtimer.h"
 
-Bool dev_check_timer (void);
 Int32 dev_delete_timer (void);
 Int32 dev_create_timer (void);
+unsigned long long dev_read_timer (void);
+Uint32 dev_timer_counts (Uint32 usec);
 
 
 #endif /* DEVTIMER_H */
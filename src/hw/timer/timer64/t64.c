@@ -46,7 +46,7 @@
  *
  * @brief
  *  This file is used to control timer64s at the device level. Only timer 0
- *  is supported, and only in single shot mode.
+ *  is supported, and only as a free running 64 bit counter.
  *
  **************************************************************************/
 #include "types.h"
@@ -105,24 +105,19 @@ Int32 dev_delete_timer (void)
  * @b  Description
  * @n
  * 
- *  Starts the timer in one shot mode
+ *  Starts the timer as a free running counter
  */
 void timer_go (void)
 {
-    long long timdiv;
-
     /* Remove reset, leave timer disabled */
     t64_tgcr = TIMER64_TGCR_64;
 
-    /* Write the timer period. 
-     * The desired period is 100mus. One cycle is 1us per MHz of the device */
-    timdiv = (long long)ibl.pllConfig[ibl_MAIN_PLL].pllOutFreqMhz / TIMER_INPUT_DIVIDER;
-    timdiv = timdiv * 100 * 1000;
-    t64_prd34 = (timdiv >> 32);
-    t64_prd12 = (timdiv & 0xffffffff);
+    /* Count through the full 64 bit range */
+    t64_prd34 = 0xffffffff;
+    t64_prd12 = 0xffffffff;
 
-    /* Start the timer in 1 shot mode */
-    t64_tcr = TIMER64_TCR_ONE_SHOT;
+    /* Start the timer in continuous mode */
+    t64_tcr = TIMER64_TCR_CONTINUOUS;
 
 }
 
@@ -131,7 +126,8 @@ void timer_go (void)
  *  @b Description
  *  @n
  *
- *  A very simple hardware driver to configure the timer as a one shot 100ms timer.
+ *  A very simple hardware driver to configure the timer as a free running counter.
+ *  The counter starts at 0.
  *
  *  @retval
  *      0  - Timer setup
@@ -165,34 +161,52 @@ Int32 dev_create_timer (void)
  *  @b  Description
  *  @n
  *  
- *   The status of the timer is returned
+ *   The count of the timer is returned. Reading the low word latches the
+ *   high word, so the two halves are consistent.
  *
  *  @retval
- *     TRUE - The timer has expired
- *     FALSE - The timer is active
+ *     The timer count
  *
  */
-Bool dev_check_timer (void)
+unsigned long long dev_read_timer (void)
 { 
-    volatile unsigned int i;
+    Uint32 lo, hi;
 
     if (timer_created == 0)
-        return (FALSE);
+        return (0);
 
-    if ((t64_tim12 != 0) || (t64_tim34 != 0))
-        return (FALSE);
+    lo = t64_tim12;
+    hi = t64_tim34;
 
-    /* The timer has expired. Restart the timer */
-    dev_delete_timer ();
+    return (((unsigned long long)hi << 32) | lo);
 
-    /* Need some delay before reprogramming the timer */
-    for (i = 0; i < 500; i++);
+}
 
-    timer_go ();
 
-    timer_created = 1;
+/**
+ *  @b  Description
+ *  @n
+ *  
+ *   The number of timer counts in a time interval is returned
+ *
+ *  @param[in]  usec
+ *     The time interval in micro-seconds
+ *
+ *  @retval
+ *     The number of timer counts, at least 1
+ *
+ */
+Uint32 dev_timer_counts (Uint32 usec)
+{ 
+    long long counts;
+
+    /* One cycle is 1us per MHz of the device */
+    counts = (long long)ibl.pllConfig[ibl_MAIN_PLL].pllOutFreqMhz * usec / TIMER_INPUT_DIVIDER;
+
+    if (counts == 0)
+        counts = 1;
 
-    return (TRUE);
+    return ((Uint32)counts);
 
 }
 
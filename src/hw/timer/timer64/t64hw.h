@@ -66,6 +66,7 @@
 
 
 #define TIMER64_TCR_ONE_SHOT      0x40
+#define TIMER64_TCR_CONTINUOUS    0x80
 #define TIMER64_TCR_DISABLE       0x00
 
 #define TIMER64_TGCR_64           0x3
@@ -740,6 +740,14 @@ typedef struct ibl_s
 
     uint16     iblEvmType;                    /**< @ref ibl_EVM_TYPE */
 
+    /* Fields added to the table go here, so the offsets of the earlier fields do not change.
+     * All ones, from an erased device after an older table, selects the default */
+
+    uint32     ethLinkPhyMask;                /**< The phy addresses, one bit each, which must report link up before
+                                                   an ethernet boot. 0 waits for any phy */
+
+    uint32     ethLinkTimeoutMs;              /**< The maximum time to wait for link up in msec. 0 selects the default */
+
     uint16     chkSum;                        /**< Ones complement checksum over the whole config structure */
 
 } ibl_t;
@@ -874,6 +882,19 @@ typedef struct iblStatus_s
 
     iblEthBootInfo_t ethParams;     /**<  Last ethernet boot attemp parameters */
 
+    uint32 nandReadyCycles;         /**<  CPU cycles the last nand read waited for the device to become ready */
+    uint32 nandReadyTimeouts;       /**<  Number of nand reads where the device did not signal ready in time */
+
+    uint32 nandEccCorrectedBits;    /**<  Number of bit errors corrected by the nand ecc since boot */
+    uint32 nandEccCorrectedBlocks;  /**<  Number of nand ecc blocks which needed correction since boot */
+
+    uint32 bisSlowCmd;              /**<  The BIS command which took the most CPU cycles */
+    uint32 bisSlowCmdAddr;          /**<  The load or function address of the slowest BIS command */
+    uint32 bisSlowCmdCycles;        /**<  CPU cycles taken by the slowest BIS command */
+
+    uint32 ethLinkWaitMs;           /**<  Time in msec the last ethernet boot waited for the phy link */
+    uint32 ethLinkTimeouts;         /**<  Number of ethernet boots where the phy link did not come up in time */
+
 } iblStatus_t;
 
 extern iblStatus_t iblStatus;
@@ -102,11 +102,35 @@ typedef struct BOOT_MODULE_FXN_TABLE
     *           the stream has been closed.
     */
    Int32 (*query)(void);
+
+   /**
+    * @brief    This API is *optional*. It reads data straight into its final
+    *           location, allowing the boot module to place received data
+    *           without staging it in intermediate buffers. Returns the number
+    *           of bytes placed, which is less than requested if the data
+    *           ended first, or -1 on error.
+    */
+   Int32 (*place)(Uint8 *ptr_buf, Uint32 num_bytes);
     
     
 }BOOT_MODULE_FXN_TABLE;
 
 
+/**
+ * @brief   A read ahead buffer in front of a boot module. The interpreters parse
+ *          their small record headers from it, so a header does not cost a boot
+ *          module read per field.
+ */
+typedef struct iblLookAhead_t
+{
+    Uint8   *buf;       /**< The read ahead buffer */
+    Uint32   size;      /**< The size of the buffer, in bytes */
+    Uint32   pos;       /**< The offset of the next unread byte in the buffer */
+    Uint32   len;       /**< The number of valid bytes in the buffer */
+
+}iblLookAhead_t;
+
+
 /* Prototypes */
 Uint32 iblBoot (BOOT_MODULE_FXN_TABLE *bootFxn, int32 dataFormat, void *formatParams);
 
@@ -115,6 +139,7 @@ void *iblMalloc (Uint32 size);
 void  iblFree   (void *mem);
 void *iblMemset (void *mem, Int32 ch, Uint32 n);
 void *iblMemcpy (void *s1, const void *s2, Uint32 n);
+Int32 iblLookAheadRead (iblLookAhead_t *la, BOOT_MODULE_FXN_TABLE *bootFxn, Uint8 *dest, Uint32 num_bytes, BOOL direct);
 
 /* squash printfs */
 void mprintf(char *x, ...);
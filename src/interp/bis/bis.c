@@ -53,6 +53,7 @@
 #include "iblloc.h"
 #include "bis.h"
 #include "iblcfg.h"
+#include "tsc.h"
 
 /**********************************************************************
  ************************** Local Structures **************************
@@ -93,13 +94,94 @@ typedef struct FN_ENTRY
 */
 FN_ENTRY     fn_table[MAX_BIS_FUNCTION_SUPPORT];
 
+/**
+ * @brief 
+ *  The structure describes a memory region.
+ *
+ * @details
+ *  Sections and functions are not loaded into any of the regions listed
+ *  in the build configuration, which hold the IBL itself.
+ */
+typedef struct BIS_MEM_REGION
+{
+    /**
+     * @brief   This is the first address of the region.
+     */
+    Uint32       start;
+
+    /**
+     * @brief   This is the size of the region in bytes.
+     */
+    Uint32       size;
+}BIS_MEM_REGION;
+
+#ifdef IBL_CFG_LOAD_PROTECT_REGIONS
+/**
+ * @brief   The memory regions which a BIS image may not load to.
+ */
+static const BIS_MEM_REGION bis_protect_regions[] = IBL_CFG_LOAD_PROTECT_REGIONS;
+#endif
+
+/**
+ * @brief   The read ahead buffer the command headers are parsed from.
+ */
+static Uint8          bis_look_buf[BIS_LOOKAHEAD_SIZE];
+static iblLookAhead_t bis_look;
+
+
+/**
+ *  @b Description
+ *  @n
+ *      The function validates the destination of a section or function
+ *      load. The range must not wrap around the end of memory and must
+ *      not overlap any of the protected memory regions. Every target
+ *      iblcfg.h lists the IBL's own memory there. A target which does not
+ *      define IBL_CFG_LOAD_PROTECT_REGIONS only gets the wrap check.
+ *
+ *  @param[in]  loadAddress
+ *      This is the address the data is loaded to.
+ *
+ *  @param[in]  sectionSize
+ *      This is the number of bytes loaded.
+ *
+ *  @retval
+ *      Valid   -   0
+ *  @retval
+ *      Invalid -   <0
+ */
+static Int32 bisCheckLoad (Uint32 loadAddress, Uint32 sectionSize)
+{
+#ifdef IBL_CFG_LOAD_PROTECT_REGIONS
+    Uint32  i;
+#endif
+
+    if (sectionSize == 0)
+        return 0;
+
+    if (loadAddress + sectionSize < loadAddress)
+        return -1;
+
+#ifdef IBL_CFG_LOAD_PROTECT_REGIONS
+    for (i = 0; i < sizeof(bis_protect_regions) / sizeof(BIS_MEM_REGION); i++)
+    {
+        if ((loadAddress < bis_protect_regions[i].start + bis_protect_regions[i].size) &&
+            (bis_protect_regions[i].start < loadAddress + sectionSize))
+            return -1;
+    }
+#endif
+
+    return 0;
+}
+
+
 
 /**
  *  @b Description
  *  @n
  *      The function interfaces with the boot module and reads data as it 
  *      is received by the boot module and executes the BIS command state
- *      machine. 
+ *      machine. The CPU cycles taken by the slowest command are recorded
+ *      in the IBL status.
  *
  *  @param[out]  entry_point
  *      This is the entry point to which control is to be transferred on
@@ -112,17 +194,30 @@ FN_ENTRY     fn_table[MAX_BIS_FUNCTION_SUPPORT];
  */
 Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
 {
+    Uint32      header[5];
     Uint32      dataWord;
+    Uint32      command;
     Uint32      loadAddress;
     Uint32      sectionSize;
     Uint32      commandFlags;
+    Uint32      start;
+    Uint32      cycles;
     Uint16      argCnt;
     Uint16      fn_num;
     FN_ENTRY*   ptr_fn_entry;
     Bool        done = FALSE;
 
+    bis_look.buf  = bis_look_buf;
+    bis_look.size = BIS_LOOKAHEAD_SIZE;
+    bis_look.pos  = 0;
+    bis_look.len  = 0;
+
+    iblStatus.bisSlowCmd       = 0;
+    iblStatus.bisSlowCmdAddr   = 0;
+    iblStatus.bisSlowCmdCycles = 0;
+
     /* Read the Magic word */
-    if ((*bootFxn->read)((Uint8 *)&dataWord, sizeof(Uint32)) < 0)    
+    if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)&dataWord, sizeof(Uint32), TRUE) < 0)    
         return -1;
 
     /* Check if we received the magic number. */
@@ -132,30 +227,29 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
     /* If magic word was good, let's start parsing commands */
     while (done == FALSE)
     {
+        start       = TSCL;
+        loadAddress = 0;
+
         /* Read BIS command */
-        if ((*bootFxn->read)((Uint8 *)&dataWord, sizeof(Uint32)) < 0)
+        if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)&command, sizeof(Uint32), TRUE) < 0)
             return -1;
 
         /* Make sure command at least has right prefix */
-        if ((dataWord & BIS_CMD_MASK) != BIS_CMD_PREFIX )
+        if ((command & BIS_CMD_MASK) != BIS_CMD_PREFIX )
             return -1;
 
         /* Process the command. */
-        switch (dataWord)
+        switch (command)
         {
             case BIS_CMD_SECTION_LOAD:
             {
-                /* Read the Section Load Header: Load Address */
-                if ((*bootFxn->read)((Uint8 *)&loadAddress, sizeof(Uint32)) < 0)
+                /* Read the Section Load Header: Load Address, Section Size and Flags */
+                if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)header, 3 * sizeof(Uint32), TRUE) < 0)
                     return -1;
 
-                /* Read the Section Load Header: Section Size */
-                if ((*bootFxn->read)((Uint8 *)&sectionSize, sizeof(Uint32)) < 0)
-                    return -1;
-
-                /* Read the Section Load Header: Flags */
-                if ((*bootFxn->read)((Uint8 *)&commandFlags, sizeof(Uint32)) < 0)
-                    return -1;
+                loadAddress  = header[0];
+                sectionSize  = header[1];
+                commandFlags = header[2];
 
 #if 0
                 /* DEBUG Message: */
@@ -166,8 +260,12 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
                 mprintf ("    Command Flags: 0x%x\n", commandFlags);
                 mprintf ("*****************************\n");
 #endif
+                /* Validate the arguments: The section must not overwrite the IBL */
+                if (bisCheckLoad (loadAddress, sectionSize) < 0)
+                    return -1;
+
                 /* Read the data from the Section Load: Payload section. */
-                if ((*bootFxn->read)((Uint8 *)loadAddress, sectionSize) < 0)
+                if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)loadAddress, sectionSize, TRUE) < 0)
                     return -1;
 
                 /* Section Load command has been processed. */
@@ -175,25 +273,16 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
             }
             case BIS_CMD_FUNCTION_LOAD:
             {
-                /* Read the Function Load Header: Load Address */
-                if ((*bootFxn->read)((Uint8 *)&loadAddress, sizeof(Uint32)) < 0)
-                    return -1;
-
-                /* Read the Function Load Header: Section Size */
-                if ((*bootFxn->read)((Uint8 *)&sectionSize, sizeof(Uint32)) < 0)
-                    return -1;
-
-                /* Read the Function Load Header: Flags */
-                if ((*bootFxn->read)((Uint8 *)&commandFlags, sizeof(Uint32)) < 0)
+                /* Read the Function Load Header: Load Address, Section Size, Flags, 
+                 * Argument Count and Function Number */
+                if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)header, 4 * sizeof(Uint32), TRUE) < 0)
                     return -1;
 
-                /* Read the Function Load Header: Argument Count */
-                if ((*bootFxn->read)((Uint8 *)&argCnt, sizeof(Uint16)) < 0)
-                    return -1;
-
-                /* Read the Function Load Header: Function Number */
-                if ((*bootFxn->read)((Uint8 *)&fn_num, sizeof(Uint16)) < 0)
-                    return -1;
+                loadAddress  = header[0];
+                sectionSize  = header[1];
+                commandFlags = header[2];
+                iblMemcpy (&argCnt, (Uint8 *)&header[3], sizeof(Uint16));
+                iblMemcpy (&fn_num, (Uint8 *)&header[3] + sizeof(Uint16), sizeof(Uint16));
 
 #if 0
                 /* DEBUG Message: */
@@ -206,12 +295,16 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
                 mprintf ("    Function Num : %d\n",   fn_num);
                 mprintf ("*****************************\n");
 #endif
+                /* Validate the arguments: The function must not overwrite the IBL */
+                if (bisCheckLoad (loadAddress, sectionSize) < 0)
+                    return -1;
+
                 /* Read the data from the Function Load: Payload section. */
-                if ((*bootFxn->read)((Uint8 *)loadAddress, sectionSize) < 0)
+                if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)loadAddress, sectionSize, TRUE) < 0)
                     return -1;
 
                 /* Validate the arguments: Ensure that the function number is in range */
-                if (fn_num > MAX_BIS_FUNCTION_SUPPORT)
+                if (fn_num >= MAX_BIS_FUNCTION_SUPPORT)
                     return -1;
 
                 /* Get access to the kernel function entry. */
@@ -237,13 +330,12 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
             {
                 void   (*fnEntryPoint)(void);
 
-                /* Read the Function Execute Header: Load Address */
-                if ((*bootFxn->read)((Uint8 *)&argCnt, sizeof(Uint16)) < 0)
+                /* Read the Function Execute Header: Argument Count and Function Number */
+                if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)header, sizeof(Uint32), TRUE) < 0)
                     return -1;
 
-                /* Read the Function Execute Header: Function Number */
-                if ((*bootFxn->read)((Uint8 *)&fn_num, sizeof(Uint16)) < 0)
-                    return -1;
+                iblMemcpy (&argCnt, (Uint8 *)&header[0], sizeof(Uint16));
+                iblMemcpy (&fn_num, (Uint8 *)&header[0] + sizeof(Uint16), sizeof(Uint16));
 
 #if 0
                 /* DEBUG Message: */
@@ -254,7 +346,7 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
                 mprintf ("*****************************\n");
 #endif
                 /* Validate the arguments: Ensure that the function number is in range */
-                if (fn_num > MAX_BIS_FUNCTION_SUPPORT)
+                if (fn_num >= MAX_BIS_FUNCTION_SUPPORT)
                     return -1;
 
                 /* Get access to the kernel function entry. */
@@ -266,6 +358,7 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
                     return -1;
 
                 /* Call the kernel function entry. */
+                loadAddress  = ptr_fn_entry->fn_address;
                 fnEntryPoint = (void (*)(void))ptr_fn_entry->fn_address;
                 fnEntryPoint();
                 break;
@@ -276,29 +369,17 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
                 Uint32  mask;
                 Uint32  sleep_cnt;
 
-                /* Read the Memory Access Header: Address */
-                if ((*bootFxn->read)((Uint8 *)&loadAddress, sizeof(Uint32)) < 0)
-                    return -1;
-
-                /* Read the Memory Access Header: Word Count */
-                if ((*bootFxn->read)((Uint8 *)&argCnt, sizeof(Uint16)) < 0)
-                    return -1;
-
-                /* Read the Memory Access Header: Op Type */
-                if ((*bootFxn->read)((Uint8 *)&op_type, sizeof(Uint16)) < 0)
+                /* Read the Memory Access Header: Address, Word Count, Op Type, Mask,
+                 * Sleep Count and Data Payload */
+                if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)header, 5 * sizeof(Uint32), TRUE) < 0)
                     return -1;
 
-                /* Read the Memory Access Header: Mask */
-                if ((*bootFxn->read)((Uint8 *)&mask, sizeof(Uint32)) < 0)
-                    return -1;
-
-                /* Read the Memory Access Header: Sleep Count */
-                if ((*bootFxn->read)((Uint8 *)&sleep_cnt, sizeof(Uint32)) < 0)
-                    return -1;
-
-                /* Read the Memory Access Header: Data Payload */
-                if ((*bootFxn->read)((Uint8 *)&dataWord, sizeof(Uint32)) < 0)
-                    return -1;
+                loadAddress = header[0];
+                iblMemcpy (&argCnt,  (Uint8 *)&header[1], sizeof(Uint16));
+                iblMemcpy (&op_type, (Uint8 *)&header[1] + sizeof(Uint16), sizeof(Uint16));
+                mask        = header[2];
+                sleep_cnt   = header[3];
+                dataWord    = header[4];
 
 #if 0
                 /* DEBUG Message: */
@@ -317,7 +398,7 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
             case BIS_CMD_SECTION_TERMINATE:
             {
                 /* Read the Terminate Command Payload  */
-                if ((*bootFxn->read)((Uint8 *)&dataWord, sizeof(Uint32)) < 0)
+                if (iblLookAheadRead (&bis_look, bootFxn, (Uint8 *)&dataWord, sizeof(Uint32), TRUE) < 0)
                     return -1;
 
                 /* DEBUG Message: */
@@ -334,17 +415,21 @@ Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point)
             default:
             {
                 /* BIS Command is not supported. */
-                mprintf ("Error: BIS Command 0x%x not supported\n", dataWord);
+                mprintf ("Error: BIS Command 0x%x not supported\n", command);
                 return -1;
             }
         }
+
+        /* Record the slowest command */
+        cycles = TSCL - start;
+        if (cycles > iblStatus.bisSlowCmdCycles)
+        {
+            iblStatus.bisSlowCmd       = command;
+            iblStatus.bisSlowCmdAddr   = loadAddress;
+            iblStatus.bisSlowCmdCycles = cycles;
+        }
     }
 
     /* Control comes here indicates that the parsing was successful. */
     return 0;
 }
-
-
-
-
-
@@ -55,6 +55,12 @@
 #define BIS_CMD_MEMORY_ACCESS     (0x42495304u)
 #define BIS_CMD_SECTION_TERMINATE (0x424953FFu)
 
+/* Size of the read ahead buffer the command headers are parsed from. It must
+ * hold the largest command with its header. */
+#ifndef BIS_LOOKAHEAD_SIZE
+#define BIS_LOOKAHEAD_SIZE        64
+#endif
+
 
 Int32 iblBootBis (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32* entry_point);
 
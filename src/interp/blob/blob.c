@@ -79,6 +79,17 @@ void iblBootBlob (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32 *entry, void *formatPar
     datap  = (Uint8 *)blobParams->startAddress;
     *entry = 0;
 
+    /* Boot modules which can place the data directly do not need the
+     * query/read loop. */
+    if (bootFxn->place != NULL)  {
+
+        erVal = (*bootFxn->place)(datap, blobParams->sizeBytes);
+        if (erVal > 0)
+            *entry = blobParams->branchAddress;
+
+        return;
+    }
+
     for (remainSize = blobParams->sizeBytes; (remainSize > 0) && (erVal == 0);   )  {
 
         /* If there is any data waiting go ahead and process it */
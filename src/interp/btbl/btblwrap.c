@@ -65,6 +65,53 @@ Int32         btblWrapEcode;
 #define MIN(a,b)  ((a) < (b)) ? (a) : (b)
 
 
+/* The boot table read ahead buffer */
+static iblLookAhead_t btblLook;
+
+
+/************************************************************************************
+ * FUNCTION PURPOSE: Read a boot table data section to its destination
+ ************************************************************************************
+ * DESCRIPTION: Sections which are a whole number of words at a word aligned
+ *              address are read straight into place, bypassing the 16 bit
+ *              repacking of the boot table processor. The table holds big 
+ *              endian words, so a little endian build swaps each word in place.
+ *              The boot table state is advanced past the section.
+ ************************************************************************************/
+static Int32 btblReadSection (BOOT_MODULE_FXN_TABLE *bootFxn)
+{
+    Uint32 *dest;
+    Uint32  sizeBytes;
+#ifndef _BIG_ENDIAN
+    Uint32  i;
+    Uint32  v;
+#endif
+
+    dest      = (Uint32 *)tiBootTable.section_addr;
+    sizeBytes = tiBootTable.section_size_bytes;
+
+    if (iblLookAheadRead (&btblLook, bootFxn, (Uint8 *)dest, sizeBytes, TRUE) < 0)
+        return (-1);
+
+#ifndef _BIG_ENDIAN
+    for (i = 0; i < (sizeBytes >> 2); i++)  {
+        v       = dest[i];
+        dest[i] = (v >> 24) | ((v >> 8) & 0x0000ff00) | ((v << 8) & 0x00ff0000) | (v << 24);
+    }
+#endif
+
+    tiBootTable.section_addr       += sizeBytes;
+    tiBootTable.section_size_bytes  = 0;
+    tiBootTable.state               = BOOT_TBL_STATE_SIZE;
+
+    chipBtblBlockDone();
+    bootStats.btbl.num_pdma_copies++;
+
+    return (0);
+
+}
+
+
 /************************************************************************************
  * FUNCTION PURPOSE: The main boot wrapper for the TI boot table processor
  ************************************************************************************
@@ -95,7 +142,7 @@ void iblBootBtbl (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32 *entry_point)
     
     boot_init_boot_tbl_inst (&tiBootTable);    
 
-    data = iblMalloc (TI_BTBL_BLOCK_SIZE);
+    data = iblMalloc (TI_BTBL_BLOCK_SIZE + TI_BTBL_LOOKAHEAD_SIZE);
     if (data == NULL)  {
         btblWrapEcode = BTBL_WRAP_ECODE_MALLOC_FAIL;
         return;
@@ -103,6 +150,11 @@ void iblBootBtbl (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32 *entry_point)
 
     data16 = (Uint16 *)data;
 
+    btblLook.buf  = &data[TI_BTBL_BLOCK_SIZE];
+    btblLook.size = TI_BTBL_LOOKAHEAD_SIZE;
+    btblLook.pos  = 0;
+    btblLook.len  = 0;
+
     while ((tiBootTable.state != BOOT_TBL_STATE_FLUSH) && (btblEcode == 0)) {
 
         switch (tiBootTable.state)  {
@@ -120,13 +172,28 @@ void iblBootBtbl (BOOT_MODULE_FXN_TABLE *bootFxn, Uint32 *entry_point)
         }
 
 
+        /* Word sections bypass the boot table processor. Only the small header
+         * states are run through the 16 bit state machine */
+        if ((tiBootTable.state == BOOT_TBL_STATE_DATA) &&
+            (((tiBootTable.section_addr | tiBootTable.section_size_bytes) & 3) == 0))  {
+
+            if (btblReadSection (bootFxn) < 0)  {
+                btblWrapEcode = BTBL_WRAP_ECODE_READ_FAIL;
+                iblFree (data);
+                return;
+            }
+
+            continue;
+        }
+
+
         while (readSize > 0)  {
 
             blockSize   = MIN(readSize, TI_BTBL_BLOCK_SIZE);
             blockSize16 = (blockSize + 1) >> 1;
 
             /* No recovery on block read failure */
-            if ((*bootFxn->read)(data, blockSize) < 0)  {
+            if (iblLookAheadRead (&btblLook, bootFxn, data, blockSize, FALSE) < 0)  {
                 btblWrapEcode = BTBL_WRAP_ECODE_READ_FAIL;
                 iblFree (data);
                 return;
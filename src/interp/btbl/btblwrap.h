@@ -111,6 +111,13 @@ void btblBootException (UINT32 ecode);
 /* The block size allocated through malloc. Chosen to match the value defined
  * for the coff loader. malloc is used so the same heap section can be used. */
 #define  TI_BTBL_BLOCK_SIZE   0x4000
+
+/* The section headers are parsed out of a small read ahead buffer, which is
+ * allocated with the block buffer. Reads into it never exceed the amount the
+ * boot device reports available through its query API. */
+#ifndef TI_BTBL_LOOKAHEAD_SIZE
+#define TI_BTBL_LOOKAHEAD_SIZE  128
+#endif
  
 /* Read/Write 32bit values */
 #define chipStoreWord(x,y)      *(x) = (y)
@@ -476,19 +476,58 @@ int cload_headers()
 /* CLOAD_DATA() - Read in the raw data and load it into memory.               */
 /*                                                                            */
 /******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/* CLOAD_SECT_ORDER() - Return the section numbers sorted by the file offset  */
+/*                      of the raw data.  Loading in this order reads the     */
+/*                      file forward in a single pass.  Returns NULL if no    */
+/*                      memory is available; sections are then loaded in      */
+/*                      header order.                                         */
+/*                                                                            */
+/******************************************************************************/
+static int *cload_sect_order(void)
+{
+   int i, j;
+   int *order = (int *)malloc(n_sections * sizeof(int));
+
+   if (order == NULL) return NULL;
+
+   /*-------------------------------------------------------------------------*/
+   /* INSERTION SORT; SECTIONS ARE NORMALLY ALREADY IN ORDER AND ARE NOT      */
+   /* MOVED.  SECTIONS WITH EQUAL OFFSETS KEEP THEIR HEADER ORDER.            */
+   /*-------------------------------------------------------------------------*/
+   for (i = 0; i < n_sections; i++)
+   {
+      for (j = i; j > 0 && 
+                  SECT_HDR(order[j - 1])->s_scnptr > SECT_HDR(i)->s_scnptr; j--)
+         order[j] = order[j - 1];
+      order[j] = i;
+   }
+
+   return order;
+}
+
 int cload_data()
 {
    int ok = TRUE;
+   int n;
+   int *order;
 
    if (!need_data) return TRUE;
 
+   order = cload_sect_order();
+
    /*-------------------------------------------------------------------------*/
-   /* LOOP THROUGH THE SECTIONS AND LOAD THEM ONE AT A TIME.                  */
+   /* LOOP THROUGH THE SECTIONS AND LOAD THEM ONE AT A TIME, IN FILE ORDER.   */
    /*-------------------------------------------------------------------------*/
-   for (curr_sect = 0; curr_sect < n_sections && ok; curr_sect++)
+   for (n = 0; n < n_sections && ok; n++)
    {
-      SCNHDR *sptr = SECT_HDR(curr_sect);                        
-      char   *sname = (sptr->s_zeroes == 0L) ? 
+      SCNHDR *sptr;
+      char   *sname;
+
+      curr_sect = (order != NULL) ? order[n] : n;
+      sptr      = SECT_HDR(curr_sect);
+      sname     = (sptr->s_zeroes == 0L) ? 
 				sptr->s_nptr : SNAMECPY(sptr->s_name);
 
       /*----------------------------------------------------------------------*/
@@ -512,11 +551,12 @@ int cload_data()
   /*-------------------------------------------------------------------------*/
   /* WE DEFERRED CINIT, LOAD IT/THEM NOW.                                    */
   /*-------------------------------------------------------------------------*/
-  for (curr_sect = 0; curr_sect < n_sections && ok; curr_sect++)
+  for (n = 0; n < n_sections && ok; n++)
   {
-     SCNHDR *sptr = SECT_HDR(curr_sect);
-     char   *sname = (sptr->s_zeroes == 0L) ? 
-			       sptr->s_nptr : SNAMECPY(sptr->s_name);
+     SCNHDR *sptr;
+
+     curr_sect = (order != NULL) ? order[n] : n;
+     sptr      = SECT_HDR(curr_sect);
      
      if (IS_CINIT(sptr))
      {
@@ -524,10 +564,38 @@ int cload_data()
      }
   }
 
+   if (order) free(order);
+
    return ok;
 }
 
 
+#if FILE_BASED
+/******************************************************************************/
+/*                                                                            */
+/* CLOAD_SECT_DIRECT() - Read the raw data of a section which needs no        */
+/*                       relocation or cinit processing straight into target  */
+/*                       memory, without copying it through a load buffer.    */
+/*                                                                            */
+/******************************************************************************/
+static int cload_sect_direct(SCNHDR *sptr)
+{
+   unsigned char *dest   = (unsigned char *)(sptr->s_vaddr + reloc_amount[curr_sect]);
+   unsigned int   length = (unsigned int)LOCTOBYTE(sptr->s_size);
+
+   if (fseek(fin, sptr->s_scnptr, 0) != 0) { load_err = E_FILE; return FALSE; }
+
+#ifdef fplace
+   if (!fplace(dest, length, fin))
+#else
+   if (fread(dest, length, 1, fin) != 1)
+#endif
+      { load_err = E_FILE; return FALSE; }
+
+   return TRUE;
+}
+#endif
+
 /******************************************************************************/
 /*                                                                            */
 /* CLOAD_SECT_DATA() - Read, relocate, and write out the data for one section.*/
@@ -545,6 +613,10 @@ int cload_sect_data(SCNHDR *sptr)
    unsigned char *packet = NULL;          /* LOAD BUFFER                      */
    unsigned int section_length = (unsigned int)LOCTOBYTE(sptr->s_size);
    unsigned int buffer_size    = LOADBUFSIZE;
+#if FILE_BASED
+   int           file_pos = -1;           /* FILE OFFSET AFTER THE LAST READ  */
+   int           read_pos;                /* FILE OFFSET OF THE NEXT READ     */
+#endif
 
 #if defined (UNBUFFERED) && UNBUFFERED
    /*-------------------------------------------------------------------------*/
@@ -555,6 +627,14 @@ int cload_sect_data(SCNHDR *sptr)
    buffer_size = MAX(buffer_size, (section_length + 32) & ~31ul); 
 #endif
 
+#if FILE_BASED && !defined(OTIS)
+   /*-------------------------------------------------------------------------*/
+   /* DATA WHICH IS NOT MODIFIED ON THE WAY IS READ STRAIGHT TO ITS ADDRESS.  */
+   /*-------------------------------------------------------------------------*/
+   if (!need_reloc && sptr->s_scnptr && !IS_CINIT(sptr))
+      return cload_sect_direct(sptr);
+#endif
+
    /*-------------------------------------------------------------------------*/
    /* ENSURE LOADBUFSIZE IS A MULTIPLE OF 2                                   */
    /*-------------------------------------------------------------------------*/
@@ -621,13 +701,23 @@ int cload_sect_data(SCNHDR *sptr)
 
       if (sptr->s_scnptr)
 #if FILE_BASED   
-	  if ((fseek(fin, sptr->s_scnptr + (int)(nbytes + excess), 0) != 0) ||
+      {
+	  /*------------------------------------------------------------------*/
+	  /* THE DATA IS READ SEQUENTIALLY, SO THE SEEK IS ONLY NEEDED FOR    */
+	  /* THE FIRST BUFFER OF THE SECTION.                                 */
+	  /*------------------------------------------------------------------*/
+	  read_pos = sptr->s_scnptr + (int)(nbytes + excess);
+
+	  if (((read_pos != file_pos) && (fseek(fin, read_pos, 0) != 0)) ||
 	      (fread(packet + excess, packet_size - excess, 1, fin) != 1))
 	   { 
 	      load_err = E_FILE; 
               free (packet);
 	      return FALSE; 
 	  }
+
+	  file_pos = read_pos + (packet_size - excess);
+      }
 #else
 	mem_copy((void*)(packet + excess), (void*)&gRxBuffer[sptr->s_scnptr + (int)(nbytes + excess)], packet_size - excess);
 #endif
@@ -677,13 +767,22 @@ int cload_sect_data(SCNHDR *sptr)
 #endif
 
 #if FILE_BASED  
-	    if (n_reloc++ < sptr->s_nreloc                                    &&
-	       (fseek(fin, sptr->s_relptr + ((int)n_reloc * relsz), 0) != 0  ||
-		 !reloc_read(&reloc)))
+	    if (n_reloc++ < sptr->s_nreloc)
+	    {
+	       /*----------------------------------------------------------*/
+	       /* THE SEEK AND READ MOVE THE FILE POINTER OFF THE SECTION  */
+	       /* DATA, SO THE NEXT DATA READ MUST SEEK BACK.              */
+	       /*----------------------------------------------------------*/
+	       file_pos = -1;
+
+	       if (fseek(fin, sptr->s_relptr + ((int)n_reloc * relsz), 0) != 0  ||
+		   !reloc_read(&reloc))
+                  { load_err = E_FILE; free (packet); return FALSE; }
+	    }
 #else
 		if (n_reloc++ < sptr->s_nreloc && !reloc_read(&reloc, sptr->s_relptr + ((int)n_reloc * relsz)));
-#endif		 
                { load_err = E_FILE; free (packet); return FALSE; }
+#endif		 
 	 }
 
       /*----------------------------------------------------------------------*/
@@ -56,6 +56,11 @@
 #define fseek(x,y,z)        (*x->seek)((Int32)(y),(Int32)(z))
 #define fread(w,x,y,z)      (((*z->read)((Uint8 *)(w),(Uint32)((x)*(y)))) == 0 ? (y) : 0)
 
+/* Read straight to the destination. Boot modules which can place data put it there
+ * without going through the read buffering. Evaluates to TRUE on success */
+#define fplace(w,x,z)       (((z)->place != NULL) ? ((*z->place)((Uint8 *)(w),(Uint32)(x)) == (Int32)(x)) : \
+                                                    ((*z->read)((Uint8 *)(w),(Uint32)(x)) == 0))
+
 /* Use stdlib functions where possible */
 #define mem_copy(dest,src,nbytes)           iblMemcpy((void *)(dest),(void *)(src),nbytes)
 #define mem_write(buf, nbytes, addr, page)  iblMemcpy((void *)(addr),(void *)(buf),nbytes)
@@ -394,6 +394,40 @@ static void initialize_loaded_module(DLIMP_Dynamic_Module *dyn_module)
 }
 #endif
 
+/*****************************************************************************/
+/* plan_segment_load_order()                                                 */
+/*                                                                           */
+/*    Return a list of indices into the loaded segments, sorted by the file  */
+/*    offset of the segment contents.  Loading the segments in this order    */
+/*    reads the object file strictly forward in a single pass, so streaming  */
+/*    sources never have to seek backwards, even when the linker emitted the */
+/*    program headers out of file offset order.  Returns NULL if no memory   */
+/*    is available for the list; the caller then loads in table order.       */
+/*                                                                           */
+/*****************************************************************************/
+static int *plan_segment_load_order(DLIMP_Loaded_Segment *seg, int nseg)
+{
+   int i, j;
+   int *order = (int *)DLIF_malloc(nseg * sizeof(int));
+
+   if (order == NULL) return NULL;
+
+   /*------------------------------------------------------------------------*/
+   /* Insertion sort; there are only a few segments and segments that are    */
+   /* already in order (the common case) are not moved.  Segments with equal */
+   /* offsets keep their program header table order.                         */
+   /*------------------------------------------------------------------------*/
+   for (i = 0; i < nseg; i++)
+   {
+      for (j = i; j > 0 && 
+                  seg[order[j - 1]].phdr.p_offset > seg[i].phdr.p_offset; j--)
+         order[j] = order[j - 1];
+      order[j] = i;
+   }
+
+   return order;
+}
+
 /*****************************************************************************/
 /* load_static_segment()                                                     */
 /*                                                                           */
@@ -407,19 +441,24 @@ static void initialize_loaded_module(DLIMP_Dynamic_Module *dyn_module)
 static BOOL load_static_segment(LOADER_FILE_DESC *fd, 
                                 DLIMP_Dynamic_Module *dyn_module)
 {
-   int i;
+   int n, i;
+   int nseg = dyn_module->loaded_module->loaded_segments.size;
    DLIMP_Loaded_Segment* seg = (DLIMP_Loaded_Segment*) 
                               (dyn_module->loaded_module->loaded_segments.buf);
+   int *order = plan_segment_load_order(seg, nseg);
 
    /*------------------------------------------------------------------------*/
    /* For each segment in the loaded module, build up a target memory        */
    /* request for the segment, get rights to target memory where we want     */
    /* to load the segment from the client, then get the client to write the  */
    /* segment contents out to target memory to the appropriate address.      */
+   /* The segments are visited in file offset order (see                     */
+   /* plan_segment_load_order()).                                            */
    /*------------------------------------------------------------------------*/
-   for (i = 0; i < dyn_module->loaded_module->loaded_segments.size; i++)
+   for (n = 0; n < nseg; n++)
    {
       struct DLOAD_MEMORY_REQUEST targ_req;
+      i = (order != NULL) ? order[n] : n;
       seg[i].obj_desc->target_page = 0;
       targ_req.flags = 0;
 
@@ -441,7 +480,11 @@ static BOOL load_static_segment(LOADER_FILE_DESC *fd,
       /* Ask the client side of the dynamic loader to allocate target memory */
       /* for this segment to be loaded into.                                 */
       /*---------------------------------------------------------------------*/
-      if (!DLIF_allocate(&targ_req)) return FALSE;
+      if (!DLIF_allocate(&targ_req))
+      {
+         if (order != NULL) DLIF_free(order);
+         return FALSE;
+      }
 
       /*---------------------------------------------------------------------*/
       /* If there is any initialized data in the segment, we'll first write  */
@@ -455,6 +498,7 @@ static BOOL load_static_segment(LOADER_FILE_DESC *fd,
       }
    }
 
+   if (order != NULL) DLIF_free(order);
    return TRUE;
 }
 
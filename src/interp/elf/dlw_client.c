@@ -163,9 +163,13 @@ BOOL DLIF_allocate(struct DLOAD_MEMORY_REQUEST *targ_req)
    {
        /* Do not clear uninitialized data section, so that the section can 
           be mapped to the same region IBL uses */ 
-       memset(targ_req->host_address, 0, obj_desc->memsz_in_bytes);
        fseek(f,targ_req->offset,SEEK_SET);
        fread(targ_req->host_address,obj_desc->objsz_in_bytes,1,f);
+
+       /* Only the part of the segment not loaded from the file is cleared */
+       if (obj_desc->memsz_in_bytes > obj_desc->objsz_in_bytes)
+           memset((uint8_t *)targ_req->host_address + obj_desc->objsz_in_bytes, 0, 
+                  obj_desc->memsz_in_bytes - obj_desc->objsz_in_bytes);
    }
 
    /*------------------------------------------------------------------------*/
@@ -69,6 +69,7 @@
 #include "led.h"
 #include "uart.h"
 #include "i2c.h"
+#include "tsc.h"
 #include <string.h>
 
 
@@ -130,6 +131,67 @@ void *iblMemcpy (void *s1, const void *s2, Uint32 n)
 
 }
 
+/**
+ *  @brief
+ *      Read interpreter data through a read ahead buffer, used for both stages of the ibl.
+ *      Bytes already read ahead are used first. Reads as large as the buffer then go
+ *      straight to the destination, through the place API if direct is TRUE and the
+ *      boot module provides it. Smaller reads refill the buffer with as much data as
+ *      the boot module query reports available, so a header and the bytes after it
+ *      cost a single boot module read. Without a query API only the requested bytes
+ *      are read.
+ */
+Int32 iblLookAheadRead (iblLookAhead_t *la, BOOT_MODULE_FXN_TABLE *bootFxn, Uint8 *dest, Uint32 num_bytes, BOOL direct)
+{
+    Uint32 n;
+    Int32  avail;
+
+    n = la->len - la->pos;
+    if (n > num_bytes)
+        n = num_bytes;
+
+    if (n > 0)  {
+        memcpy (dest, &la->buf[la->pos], n);
+        la->pos   += n;
+        dest      += n;
+        num_bytes -= n;
+    }
+
+    if (num_bytes == 0)
+        return (0);
+
+    if (num_bytes >= la->size)  {
+
+        if ((direct == TRUE) && (bootFxn->place != NULL))  {
+            if ((*bootFxn->place)(dest, num_bytes) != (Int32)num_bytes)
+                return (-1);
+
+        }  else  {
+            if ((*bootFxn->read)(dest, num_bytes) < 0)
+                return (-1);
+        }
+
+        return (0);
+    }
+
+    n = num_bytes;
+    if (bootFxn->query != NULL)  {
+        avail = (*bootFxn->query)();
+        if (avail > (Int32)num_bytes)
+            n = ((Uint32)avail < la->size) ? (Uint32)avail : la->size;
+    }
+
+    if ((*bootFxn->read)(la->buf, n) < 0)
+        return (-1);
+
+    memcpy (dest, la->buf, num_bytes);
+    la->pos = num_bytes;
+    la->len = n;
+
+    return (0);
+
+}
+
 /**
  *  @brief
  *      Ones complement addition
@@ -351,6 +413,9 @@ void iblSwap (void)
     }
 
     ibl.iblEvmType = swap16val (ibl.iblEvmType);
+
+    ibl.ethLinkPhyMask   = swap32val (ibl.ethLinkPhyMask);
+    ibl.ethLinkTimeoutMs = swap32val (ibl.ethLinkTimeoutMs);
     ibl.chkSum = swap16val (ibl.chkSum);
 }
 
@@ -460,6 +525,9 @@ void main (void)
     uint32       devstat = 0;
     BOOT_MODULE_FXN_TABLE *bFxnTbl;
 
+    /* Start the time stamp counter used to time the boot operations */
+    iblTscStart ();
+
     deviceUnlock();
     deviceMainPllConfig(1, 20, 2);
 
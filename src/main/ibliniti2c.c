@@ -138,6 +138,23 @@ Int32 iblI2cRead (Uint8 *buf, Uint32 num_bytes)
 }
 
 
+/**
+ *  @brief
+ *      Return the number of bytes that can be read without another I2C block read.
+ *      When the fifo is empty the next block is read, since the caller only queries
+ *      when it is about to read. Data past the end of the table is never requested,
+ *      so the read ahead can not run into memory that holds no valid block.
+ */
+Int32 iblI2cQuery (void)
+{
+    if (iFifoCount() == 0)
+        i2cReadBlock ();
+
+    return ((Int32)iFifoCount());
+
+}
+
+
 /**
  *  @brief
  *      The module function table used for boot from i2c
@@ -150,7 +167,8 @@ BOOT_MODULE_FXN_TABLE i2cinit_boot_module =
     NULL,           /* Write API */
     NULL,           /* Peek  API */
     NULL,           /* Seek  API */
-    NULL            /* Query API */
+    iblI2cQuery,    /* Query API */
+    NULL            /* Place API */
 };
 
 
@@ -133,6 +133,23 @@ Int32 iblSpiRead (Uint8 *buf, Uint32 num_bytes)
 }
 
 
+/**
+ *  @brief
+ *      Return the number of bytes that can be read without another SPI block read.
+ *      When the fifo is empty the next block is read, since the caller only queries
+ *      when it is about to read. Data past the end of the table is never requested,
+ *      so the read ahead can not run into memory that holds no valid block.
+ */
+Int32 iblSpiQuery (void)
+{
+    if (iFifoCount() == 0)
+        spiReadBlock ();
+
+    return ((Int32)iFifoCount());
+
+}
+
+
 /**
  *  @brief
  *      The module function table used for boot from spi
@@ -145,7 +162,8 @@ BOOT_MODULE_FXN_TABLE spiinit_boot_module =
     NULL,           /* Write API */
     NULL,           /* Peek  API */
     NULL,           /* Seek  API */
-    NULL            /* Query API */
+    iblSpiQuery,    /* Query API */
+    NULL            /* Place API */
 };
 
 
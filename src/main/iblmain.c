@@ -65,6 +65,7 @@
 #include "spi_api.h"
 #include "ibl_elf.h"
 #include "uart.h"
+#include "tsc.h"
 #include <string.h>
 
 extern cregister unsigned int IER;
@@ -290,6 +291,10 @@ void main (void)
     iblStatus.iblMagic   = ibl_MAGIC_VALUE;
     iblStatus.iblVersion = ibl_VERSION;
 
+    /* Start the time stamp counter used to time the boot operations. It is
+     * already running if the first stage ran */
+    iblTscStart ();
+
     /* Power up the timer */
     devicePowerPeriph (TARGET_PWR_TIMER_0);
 
@@ -307,8 +312,16 @@ void main (void)
         }
     }
 
-    /* DDR configuration is device specific */
+    /* DDR configuration is device specific. Where the device supports it the
+     * configuration completes as a background task of the timer scheduler, while
+     * the boot peripheral is brought up. It is waited for before any data is
+     * loaded to memory */
+#ifdef DEVICE_DDR_POLL
+    deviceDdrStart ();
+    timer_task_add (deviceDdrPoll);
+#else
     deviceDdrConfig ();
+#endif
 
     v = DEVICE_REG32_R(DEVICE_REG_DEVSTAT);
     boot_type = ((v >> 4) & 0x3);
@@ -330,6 +343,7 @@ void main (void)
 #else
             LED_smart('0');
 #endif
+            timer_task_wait ();
             waitForBoot(0x87fffc);
         }
         break;
@@ -540,6 +554,8 @@ Uint32 iblBoot (BOOT_MODULE_FXN_TABLE *bootFxn, Int32 dataFormat, void *formatPa
 
     iblStatus.activeFileFormat = dataFormat;
 
+    /* Memory must be configured before the image is loaded */
+    timer_task_wait ();
 
     /* Invoke the parser */
     switch (dataFormat)  {
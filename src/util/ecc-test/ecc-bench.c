@@ -0,0 +1,100 @@
+/* ecc-bench.c: compare the ECC kernels and measure their throughput */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "types.h"
+#include "ecc/ecc.h"
+
+#define MAX_BLOCKS  4096
+#define PASSES      200
+
+/* The ECC code uses the word kernel for word aligned blocks and the byte
+ * kernel otherwise. The same data is kept at an aligned and at an unaligned
+ * address so both kernels run on the same patterns. */
+uint32_t aligned[MAX_BLOCKS * 4096 / 4];
+uint8_t  unaligned_buf[MAX_BLOCKS * 4096 + 1];
+uint8_t  ecc_word[64];
+uint8_t  ecc_byte[64];
+int block_size;
+int ecc_size;
+
+double bench(const uint8_t *data, int nblocks)
+{
+    clock_t start;
+    double  secs;
+    int     pass;
+    int     i;
+
+    start = clock();
+    for (pass = 0; pass < PASSES; pass++)
+    {
+	for (i = 0; i < nblocks; i++)
+	    eccComputeECC(data + i * block_size, ecc_word);
+    }
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    return ((double)nblocks * block_size * PASSES / secs / (1024 * 1024));
+}
+
+int main(int argc, const char* argv[])
+{
+    FILE* fp;
+    int i;
+    int nblocks;
+    int mismatches = 0;
+    uint8_t *data_word = (uint8_t *)aligned;
+    uint8_t *data_byte = unaligned_buf + 1;
+    
+    block_size = eccBytesPerBlock();
+    ecc_size   = eccNumBytes();
+    printf("ECC block size = %d  ECC value size = %d\n", block_size, ecc_size);
+    if (block_size > 4096 || ecc_size > sizeof(ecc_word) )
+    {
+	fprintf(stderr, "Error max block size = %d and max ecc value size =%d\n", 4096, (int)sizeof(ecc_word));
+	exit(2);
+    }
+    
+    if (argc != 2)
+    {
+	fprintf(stderr, "Error, need input data filename as only argument\n");
+	exit(2);
+    }
+    
+    fp = fopen(argv[1], "rb");
+    if (fp == NULL)
+    {
+	fprintf(stderr, "can't open pattern input file %s", argv[1]);
+	exit(2);
+    }
+
+    nblocks = fread(data_word, block_size, MAX_BLOCKS, fp);
+    fclose(fp);
+    if (nblocks == 0)
+    {
+	fprintf(stderr, "no complete block in input file\n");
+	exit(2);
+    }
+    memcpy(data_byte, data_word, nblocks * block_size);
+
+    /* Both kernels must produce identical codes */
+    for (i = 0; i < nblocks; i++)
+    {
+	eccComputeECC(data_word + i * block_size, ecc_word);
+	eccComputeECC(data_byte + i * block_size, ecc_byte);
+	if (memcmp(ecc_word, ecc_byte, ecc_size) != 0)
+	{
+	    printf("block %6d: word and byte kernel codes differ\n", i);
+	    mismatches++;
+	}
+    }
+    printf("%d blocks compared, %d mismatches\n", nblocks, mismatches);
+
+    printf("byte kernel: %8.1f MB/s\n", bench(data_byte, nblocks));
+    printf("word kernel: %8.1f MB/s\n", bench(data_word, nblocks));
+
+    return (mismatches ? 1 : 0);
+}
@@ -0,0 +1,113 @@
+/* ecc-inject.c: inject random bit errors and check the ECC corrects them */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "types.h"
+#include "ecc/ecc.h"
+
+#define TRIALS      2000
+
+uint8_t block[4096];
+uint8_t bad[4096];
+uint8_t ecc_good[64];
+uint8_t ecc_read[64];
+uint8_t ecc_calc[64];
+int block_size;
+int ecc_size;
+
+/* Flip nbits distinct bits across the data and the stored ecc */
+void inject(int nbits)
+{
+    int total = (block_size + ecc_size) * 8;
+    int flipped[64];
+    int i, j, bit;
+
+    for (i = 0; i < nbits; i++)
+    {
+	do {
+	    bit = rand() % total;
+	    for (j = 0; j < i && flipped[j] != bit; j++)
+		;
+	} while (j < i);
+	flipped[i] = bit;
+
+	if (bit < block_size * 8)
+	    bad[bit >> 3] ^= 0x80 >> (bit & 7);
+	else
+	    ecc_read[(bit >> 3) - block_size] ^= 0x80 >> (bit & 7);
+    }
+}
+
+int main(int argc, const char* argv[])
+{
+    int max_bits;
+    int nbits;
+    int trial;
+    int i;
+    int fails = 0;
+
+    block_size = eccBytesPerBlock();
+    ecc_size   = eccNumBytes();
+    printf("ECC block size = %d  ECC value size = %d\n", block_size, ecc_size);
+
+    if (argc != 2)
+    {
+	fprintf(stderr, "Error, need the max number of bit errors to inject as only argument\n");
+	exit(2);
+    }
+    max_bits = atoi(argv[1]);
+    if (max_bits < 0 || max_bits > 32)
+    {
+	fprintf(stderr, "Error, bit errors must be 0 to 32\n");
+	exit(2);
+    }
+
+    srand(1);
+
+    /* An erased block must read back clean */
+    memset(block, 0xff, block_size);
+    memset(ecc_read, 0xff, ecc_size);
+    eccComputeECC(block, ecc_calc);
+    if (eccCorrectData(block, ecc_read, ecc_calc) != ECC_SUCCESS || memcmp(ecc_read, ecc_calc, ecc_size))
+    {
+	printf("erased block: FAIL\n");
+	fails++;
+    }
+
+    for (nbits = 0; nbits <= max_bits + 1; nbits++)
+    {
+	int corrected = 0, detected = 0, wrong = 0;
+
+	for (trial = 0; trial < TRIALS; trial++)
+	{
+	    for (i = 0; i < block_size; i++)
+		block[i] = rand();
+	    eccComputeECC(block, ecc_good);
+
+	    memcpy(bad, block, block_size);
+	    memcpy(ecc_read, ecc_good, ecc_size);
+	    inject(nbits);
+
+	    eccComputeECC(bad, ecc_calc);
+	    if (eccCorrectData(bad, ecc_read, ecc_calc) != ECC_SUCCESS)
+		detected++;
+	    else if (memcmp(bad, block, block_size) == 0)
+		corrected++;
+	    else
+		wrong++;
+	}
+
+	printf("%2d bit errors: %5d corrected %5d detected %5d miscorrected\n", nbits, corrected, detected, wrong);
+
+	/* Everything up to max_bits has to be corrected */
+	if (nbits <= max_bits && corrected != TRIALS)
+	    fails++;
+    }
+
+    printf("%s\n", fails ? "FAIL" : "PASS");
+
+    return (fails ? 1 : 0);
+}
@@ -0,0 +1,54 @@
+/*
+ *
+ * Copyright (C) 2010 Texas Instruments Incorporated - http://www.ti.com/ 
+ * 
+ * 
+ *  Redistribution and use in source and binary forms, with or without 
+ *  modification, are permitted provided that the following conditions 
+ *  are met:
+ *
+ *    Redistributions of source code must retain the above copyright 
+ *    notice, this list of conditions and the following disclaimer.
+ *
+ *    Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the 
+ *    documentation and/or other materials provided with the   
+ *    distribution.
+ *
+ *    Neither the name of Texas Instruments Incorporated nor the names of
+ *    its contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS 
+ *  "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT 
+ *  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *  A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT 
+ *  OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, 
+ *  SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT 
+ *  LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *  DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *  THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT 
+ *  (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE 
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+*/
+/* target.h: host stand in for the device target.h used by nand-read-bench.
+ * The EMIF data register is a mock that returns the next bytes of a pattern
+ * on every read, at the width of the access. */
+
+#ifndef _EMIF_MOCK_TARGET_H
+#define _EMIF_MOCK_TARGET_H
+
+#define DEVICE_EMIF25_BASE  0x70000000
+
+unsigned int mockRegRead  (unsigned int addr, int width);
+void         mockRegWrite (unsigned int addr, unsigned int value, int width);
+
+#define DEVICE_REG32_R(x)    mockRegRead  ((unsigned int)(x), 4)
+#define DEVICE_REG32_W(x,y)  mockRegWrite ((unsigned int)(x), (y), 4)
+#define DEVICE_REG16_R(x)    mockRegRead  ((unsigned int)(x), 2)
+#define DEVICE_REG16_W(x,y)  mockRegWrite ((unsigned int)(x), (y), 2)
+#define DEVICE_REG8_R(x)     mockRegRead  ((unsigned int)(x), 1)
+#define DEVICE_REG8_W(x,y)   mockRegWrite ((unsigned int)(x), (y), 1)
+
+#endif /* _EMIF_MOCK_TARGET_H */
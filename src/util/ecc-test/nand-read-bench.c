@@ -0,0 +1,159 @@
+/* nand-read-bench.c: check the EMIF nand data reads against a mocked data register */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+
+/* The driver is built as is. The emif-mock target.h routes its register
+ * accesses to mockRegRead and mockRegWrite below. */
+#define cregister
+#include "hw/nands/emif25/nandemif25.c"
+
+#define PATTERN_SIZE  (2 * 4096)
+#define PAGE_BYTES    2048
+#define PASSES        20000
+
+uint8_t  pattern[PATTERN_SIZE];
+int      pattern_pos;
+long     reg_reads;
+
+volatile Uint32 TSCL;
+iblStatus_t     iblStatus;
+
+/* The data register returns the next width bytes of the pattern, the
+ * first byte in the low lane, as the EMIF packs them on a little endian
+ * device. Every other register reads as zero. */
+unsigned int mockRegRead (unsigned int addr, int width)
+{
+    unsigned int v = 0;
+    int i;
+
+    if (addr != memBase)
+	return (0);
+
+    for (i = 0; i < width; i++)
+	v |= (unsigned int)pattern[(pattern_pos + i) % PATTERN_SIZE] << (8 * i);
+
+    pattern_pos = (pattern_pos + width) % PATTERN_SIZE;
+    reg_reads++;
+
+    return (v);
+}
+
+void mockRegWrite (unsigned int addr, unsigned int value, int width)
+{
+}
+
+void chipDelay32 (uint32 del)
+{
+}
+
+uint32 deviceEmif25MemBase (int32 cs)
+{
+    return (0x74000000);
+}
+
+void uart_write_string (char *str, uint32_t length)
+{
+}
+
+/* The reference read, one bus width access per byte */
+void read_bytewise (Uint32 nbytes, Uint8 *data)
+{
+    Uint32 i;
+
+    for (i = 0; i < nbytes; i++)
+	data[i] = DEVICE_REG8_R(memBase);
+}
+
+int check (int bus_width)
+{
+    static const int sizes[] = { 0, 1, 2, 3, 4, 5, 7, 8, 15, 16, 17, 31, 33, 64, 512, 2048, 2112 };
+    uint8_t got[4096 + 8];
+    uint8_t ref[4096 + 8];
+    int     fails = 0;
+    int     s, off, start;
+
+    hwDevInfo->busWidthBits = bus_width;
+
+    for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+    {
+	for (off = 0; off < 4; off++)
+	{
+	    /* A 16 bit bus reads whole words, so only even starts are valid there */
+	    start = (bus_width == 8) ? (s * 3 + off) : (s * 4 + off * 2);
+
+	    memset (ref, 0xa5, sizeof(ref));
+	    pattern_pos = start;
+	    read_bytewise (sizes[s], ref + off);
+
+	    memset (got, 0xa5, sizeof(got));
+	    pattern_pos = start;
+	    nandReadDataBytes (sizes[s], got + off);
+
+	    if (memcmp (got + off, ref + off, sizes[s]) != 0)
+	    {
+		printf ("bus %2d bits: %4d bytes at offset %d differ from the byte reads\n",
+			bus_width, sizes[s], off);
+		fails++;
+	    }
+	}
+    }
+
+    return (fails);
+}
+
+double bench (int bus_width, int packed, double *bytes_per_read)
+{
+    static uint32_t page[PAGE_BYTES / 4];
+    clock_t start;
+    double  secs;
+    int     pass;
+
+    hwDevInfo->busWidthBits = bus_width;
+    reg_reads = 0;
+
+    start = clock();
+    for (pass = 0; pass < PASSES; pass++)
+    {
+	if (packed)
+	    nandReadDataBytes (PAGE_BYTES, (Uint8 *)page);
+	else
+	    read_bytewise (PAGE_BYTES, (Uint8 *)page);
+    }
+    secs = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    *bytes_per_read = (double)PAGE_BYTES * PASSES / reg_reads;
+
+    return ((double)PAGE_BYTES * PASSES / secs / (1024 * 1024));
+}
+
+int main (int argc, char *argv[])
+{
+    nandDevInfo_t dev;
+    double mbs, bpr;
+    int    fails;
+    int    i;
+
+    for (i = 0; i < PATTERN_SIZE; i++)
+	pattern[i] = (uint8_t)(rand() >> 7);
+
+    memset (&dev, 0, sizeof(dev));
+    gCs       = 2;
+    hwDevInfo = &dev;
+    memBase   = deviceEmif25MemBase (gCs);
+
+    fails = check (8) + check (16);
+    printf ("packed reads: %s\n", fails ? "FAILED" : "match the byte reads");
+
+    mbs = bench (8, 0, &bpr);
+    printf ("byte reads:          %8.1f MB/s, %.2f bytes per register read\n", mbs, bpr);
+    mbs = bench (8, 1, &bpr);
+    printf ("packed reads, 8 bit: %8.1f MB/s, %.2f bytes per register read\n", mbs, bpr);
+    mbs = bench (16, 1, &bpr);
+    printf ("packed reads, 16 bit:%8.1f MB/s, %.2f bytes per register read\n", mbs, bpr);
+
+    return (fails ? 1 : 0);
+}
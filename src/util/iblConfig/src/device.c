@@ -105,6 +105,10 @@ ibl_t c6455_ibl_config(void)
     /* Alternative bootMode not configured for now */
     ibl.bootModes[1].bootMode = ibl_BOOT_MODE_NONE;
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -216,6 +220,10 @@ ibl_t c6474_ibl_config(void)
     /* Alternative bootMode not configured for now */
     ibl.bootModes[1].bootMode = ibl_BOOT_MODE_NONE;
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -383,6 +391,10 @@ ibl_t c6474l_ibl_config(void)
     /* bootMode[2] not configured */
     ibl.bootModes[2].bootMode = ibl_BOOT_MODE_NONE;
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -548,6 +560,10 @@ ibl_t c6457_ibl_config(void)
     /* bootMode[2] not configured */
     ibl.bootModes[2].bootMode = ibl_BOOT_MODE_NONE;
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -708,6 +724,10 @@ ibl_t c6472_ibl_config(void)
     /* bootMode[2] not configured */
     ibl.bootModes[2].bootMode = ibl_BOOT_MODE_NONE;
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -1177,6 +1197,10 @@ ibl_t c6678_ibl_config(void)
     ibl.bootModes[2].u.ethBoot.blob.sizeBytes     = 0x20000000;
     ibl.bootModes[2].u.ethBoot.blob.branchAddress = 0x80000000;       /* Branch address after loading */
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -1380,6 +1404,10 @@ ibl_t c6670_ibl_config(void)
     ibl.bootModes[2].u.ethBoot.blob.sizeBytes     = 0x20000000;
     ibl.bootModes[2].u.ethBoot.blob.branchAddress = 0x80000000;       /* Branch address after loading */
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -1594,6 +1622,10 @@ ibl_t c6657_ibl_config(void)
     ibl.bootModes[2].u.ethBoot.blob.sizeBytes     = 0x20000000;
     ibl.bootModes[2].u.ethBoot.blob.branchAddress = 0x80000000;       /* Branch address after loading */
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);
@@ -1814,6 +1846,10 @@ ibl_t tci6634k2k_ibl_config(void)
     ibl.bootModes[2].u.ethBoot.blob.sizeBytes     = 0x20000000;
     ibl.bootModes[2].u.ethBoot.blob.branchAddress = 0x80000000;       /* Branch address after loading */
 
+    /* Wait up to the default time for any phy to report link up */
+    ibl.ethLinkPhyMask   = 0;
+    ibl.ethLinkTimeoutMs = 0;
+
     ibl.chkSum = 0;
 
     return(ibl);